@@ -12,27 +12,142 @@
 #include <coil.h>
 #include <stdint.h>
 #include <stddef.h>
+#include <stdio.h>
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+/**
+* @brief Section header flag marking section data compressed by cop_process
+*
+* Relocations of a compressed section refer to offsets of the uncompressed
+* bytes, readers inflate the sections they need with cop_section_decompress.
+*/
+#define COP_SECTION_FLAG_COMPRESSED (1u << 31)
+
+/**
+* @brief Target architectures
+*/
+typedef enum cop_arch_e {
+  COP_ARCH_X86,     ///< x86 16 bit
+  COP_ARCH_X86_32,  ///< x86 32 bit
+  COP_ARCH_X86_64,  ///< x86 64 bit
+} cop_arch_t;
+
+/**
+* @brief Code generation options
+*
+* Alignments are in bytes and must be a power of two, 0 or 1 disables them.
+*/
+typedef struct cop_config_s {
+  cop_arch_t arch;              ///< Target architecture
+  coil_u32_t function_align;    ///< Alignment of function entries, applied through the native section alignment
+  coil_u32_t loop_align;        ///< Alignment of loop heads (back-edge targets), at most the native section alignment
+  coil_u32_t align_max_skip;    ///< Largest padding allowed at one alignment point, 0 for alignment - 1
+  coil_u32_t align_budget;      ///< Largest total padding allowed per section, 0 for unlimited
+  int compress;                 ///< Compress native sections in the output object
+  coil_u32_t inline_threshold;  ///< Largest function inlined into its callers, in COIL instructions, 0 disables inlining
+  const char *const *roots;     ///< Symbols to lower code from, only the sections they reach are lowered
+  coil_size_t root_count;       ///< Number of roots, 0 lowers every section
+  int instrument;               ///< Wrap functions with cycle counter probes, x86-64 only
+  const char *const *probes;    ///< Symbols of the functions to probe
+  coil_size_t probe_count;      ///< Number of probes, 0 probes every function
+  int probe_counter;            ///< Performance counter read with rdpmc, -1 reads the time stamp counter with rdtsc
+} cop_config_t;
+
+/**
+* @brief Statistics collected during cop_process
+*/
+typedef struct cop_stats_s {
+  coil_size_t sections;          ///< COIL sections lowered to native code
+  coil_size_t unreachable;       ///< Code sections not reachable from the roots, kept as IR only
+  coil_size_t native_bytes;      ///< Native bytes emitted, padding included
+  coil_size_t symbols;           ///< Symbols copied into the destination object
+  coil_size_t strings_deduped;   ///< Section and symbol names already present in the destination string table
+  coil_size_t leaf_functions;    ///< Functions making no calls
+  coil_size_t frameless;         ///< Functions with no prologue or epilogue at all
+  coil_size_t saved_regs;        ///< Callee saved registers pushed, summed over functions
+  coil_size_t inline_sites;      ///< Call sites inlined
+  coil_size_t inline_ir_before;  ///< IR bytes of the sections calls were inlined into, before inlining
+  coil_size_t inline_ir_after;   ///< IR bytes of the same sections after inlining
+  coil_size_t probed;            ///< Functions wrapped with probes
+  coil_size_t tail_calls;        ///< Calls in tail position lowered to jumps
+  coil_size_t align_points;      ///< Alignment points padded
+  coil_size_t align_skipped;     ///< Alignment points left unpadded due to max skip or budget
+  coil_size_t align_bytes;       ///< Padding bytes emitted for alignment, function entries counted at their worst case
+  coil_size_t packed_count;      ///< Native sections stored compressed
+  coil_size_t packed_in;         ///< Bytes given to the compressor
+  coil_size_t packed_out;        ///< Bytes stored after compression, incompressible sections included as is
+  coil_u64_t compress_ns;        ///< Time spent compressing
+  coil_size_t inflated;          ///< Bytes produced inflating compressed sections again, sections stored as is excluded
+  coil_u64_t inflate_ns;         ///< Time spent inflating compressed sections again to measure and verify them
+} cop_stats_t;
+
+/**
+* @brief Fill a configuration with the default options
+*
+* @param conf Configuration to fill
+*/
+void cop_config_default(cop_config_t *conf);
+
+/**
+* @brief Print statistics in a human readable format
+*
+* @param stream Output stream
+* @param stats Statistics from cop_process
+*/
+void cop_stats_print(FILE *stream, const cop_stats_t *stats);
+
 /**
 * @brief Process the COIL IR and generate native code
 *
 * Calls underlying code generator process function based on config
 *
-* @param ssrc Source COIL object
+* The sections and symbols of src are copied into dest first, the string
+* table of dest only holds their names, each distinct name once.
+*
 * @param dest Destination COIL object
-* @param conf Compilation target
-* 
+* @param src Source COIL object
+* @param conf Code generation options
+* @param stats Statistics to accumulate into, may be NULL
+*
+* @return cop_err_t COP_ERR_GOOD on success
+* @return cop_err_t Error code on failure
+*/
+cop_err_t cop_process(coil_object_t *dest, coil_object_t *src, const cop_config_t *conf, cop_stats_t *stats);
+
+/**
+* @brief Decompress a section in place
+*
+* Does nothing if header does not carry COP_SECTION_FLAG_COMPRESSED.
+*
+* @param header Section header, COP_SECTION_FLAG_COMPRESSED is cleared on success
+* @param sect Section to decompress
+*
+* @return cop_err_t COP_ERR_GOOD on success
+* @return cop_err_t COP_ERR_FORMAT if the section is corrupt
+*/
+cop_err_t cop_section_decompress(coil_section_header_t *header, coil_section_t *sect);
+
+/**
+* @brief Print a report of the counters of an instrumented object
+*
+* The counters are the bytes of the profile section, from __cop_prof to
+* __cop_prof_end, as dumped by the running program.
+*
+* @param stream Output stream
+* @param obj Object built with instrument set
+* @param counters Counter dump
+* @param size Size of the dump in bytes
+*
 * @return cop_err_t COP_ERR_GOOD on success
 * @return cop_err_t Error code on failure
 */
-cop_err_t cop_process(coil_object_t *dest, coil_object_t *src);
+cop_err_t cop_profile_report(FILE *stream, coil_object_t *obj, const void *counters, coil_size_t size);
 
 #ifdef __cplusplus
 }
 #endif
 
-#endif /* __COP_INCLUDE_GUARD_H */
\ No newline at end of file
+#endif /* __COP_INCLUDE_GUARD_H */
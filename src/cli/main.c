@@ -1,18 +1,213 @@
 #include <cop.h>
+#include <stdlib.h>
+#include <string.h>
 
+static void usage(FILE *stream) {
+  fprintf(stream,
+    "usage: cop [options] -o output.coilo input.coil\n"
+    "       cop --report=DUMP input.coilo\n"
+    "  --arch=x86|x86-32|x86-64  target architecture (default x86-64)\n"
+    "  --align-functions=N       align function entries to N bytes (default 16, 0 disables)\n"
+    "  --align-loops=N           align loop heads to N bytes (default 16, 0 disables)\n"
+    "  --align-max-skip=N        never pad more than N bytes at one point\n"
+    "  --align-budget=N          never pad more than N bytes per section\n"
+    "  --root=SYMBOL             only lower code reachable from SYMBOL, may be repeated\n"
+    "  --inline-threshold=N      inline functions of up to N COIL instructions (default 0, off)\n"
+    "  --instrument              count calls and cycles of every function (x86-64)\n"
+    "  --instrument=SYMBOL       only instrument SYMBOL, may be repeated\n"
+    "  --probe-counter=N         count performance counter N with rdpmc instead of the time stamp counter\n"
+    "  --report=DUMP             print the counters dumped from the profile section of an instrumented program\n"
+    "  --compress                compress native sections in the output object\n"
+    "  --stats                   print code generation statistics\n"
+    "  --help                    print this message\n");
+}
+
+// Read a whole file into a malloc'd buffer
+static void *read_file(const char *path, coil_size_t *size) {
+  FILE *file = fopen(path, "rb");
+  void *data = NULL;
+  long len;
+
+  if (!file) return NULL;
+  if (fseek(file, 0, SEEK_END) == 0 && (len = ftell(file)) >= 0 && fseek(file, 0, SEEK_SET) == 0) {
+    data = malloc(len ? (size_t)len : 1);
+    if (data && fread(data, 1, (size_t)len, file) != (size_t)len) {
+      free(data);
+      data = NULL;
+    }
+    *size = (coil_size_t)len;
+  }
+
+  fclose(file);
+  return data;
+}
+
+// Print the profile report of an instrumented object
+static int report(const char *input, const char *dump) {
+  coil_size_t size = 0;
+  void *counters = read_file(dump, &size);
+  if (!counters) {
+    fprintf(stderr, "cop: failed to read '%s'\n", dump);
+    return 1;
+  }
+
+  coil_object_t obj;
+  coil_err_t err = coil_object_load_file(&obj, input);
+  if (err != COIL_ERR_GOOD) {
+    fprintf(stderr, "cop: failed to load '%s'\n", input);
+    free(counters);
+    return 1;
+  }
+
+  err = cop_profile_report(stdout, &obj, counters, size);
+  if (err != COIL_ERR_GOOD) fprintf(stderr, "cop: failed to report '%s'\n", dump);
+
+  coil_object_cleanup(&obj);
+  free(counters);
+  return err == COIL_ERR_GOOD ? 0 : 1;
+}
+
+// Parse a power of two alignment, 0 and 1 disable alignment
+static int parse_align(const char *arg, coil_u32_t *out) {
+  char *end;
+  unsigned long value = strtoul(arg, &end, 0);
+  if (*end || value > 4096 || (value & (value - 1))) return 0;
+  *out = (coil_u32_t)value;
+  return 1;
+}
+
+static int parse_size(const char *arg, coil_u32_t *out) {
+  char *end;
+  unsigned long value = strtoul(arg, &end, 0);
+  if (*end || value > UINT32_MAX) return 0;
+  *out = (coil_u32_t)value;
+  return 1;
+}
 
 int main(int argc, char **argv) {
+  const char *input = NULL;
+  const char *output = NULL;
+  const char *dump = NULL;
+  int print_stats = 0;
+  cop_config_t conf;
+  cop_stats_t stats;
+  int status = 1;
+  int ok = 1;
+
   // Parse Arguments
+  cop_config_default(&conf);
+  memset(&stats, 0, sizeof(stats));
+
+  // there can not be more roots or probes than arguments
+  const char **roots = malloc(argc * sizeof(const char *));
+  const char **probes = malloc(argc * sizeof(const char *));
+  coil_size_t root_count = 0;
+  coil_size_t probe_count = 0;
+  if (!roots || !probes) goto done;
+
+  for (int i = 1; i < argc; ++i) {
+    const char *arg = argv[i];
+
+    if (strcmp(arg, "-o") == 0 && i + 1 < argc) {
+      output = argv[++i];
+    } else if (strcmp(arg, "--arch=x86") == 0) {
+      conf.arch = COP_ARCH_X86;
+    } else if (strcmp(arg, "--arch=x86-32") == 0) {
+      conf.arch = COP_ARCH_X86_32;
+    } else if (strcmp(arg, "--arch=x86-64") == 0) {
+      conf.arch = COP_ARCH_X86_64;
+    } else if (strncmp(arg, "--align-functions=", 18) == 0) {
+      ok = parse_align(arg + 18, &conf.function_align);
+    } else if (strncmp(arg, "--align-loops=", 14) == 0) {
+      ok = parse_align(arg + 14, &conf.loop_align);
+    } else if (strncmp(arg, "--align-max-skip=", 17) == 0) {
+      ok = parse_size(arg + 17, &conf.align_max_skip);
+    } else if (strncmp(arg, "--align-budget=", 15) == 0) {
+      ok = parse_size(arg + 15, &conf.align_budget);
+    } else if (strncmp(arg, "--root=", 7) == 0) {
+      roots[root_count++] = arg + 7;
+      ok = arg[7] != '\0';
+    } else if (strncmp(arg, "--inline-threshold=", 19) == 0) {
+      ok = parse_size(arg + 19, &conf.inline_threshold);
+    } else if (strcmp(arg, "--instrument") == 0) {
+      conf.instrument = 1;
+    } else if (strncmp(arg, "--instrument=", 13) == 0) {
+      conf.instrument = 1;
+      probes[probe_count++] = arg + 13;
+      ok = arg[13] != '\0';
+    } else if (strncmp(arg, "--probe-counter=", 16) == 0) {
+      coil_u32_t counter = 0;
+      ok = parse_size(arg + 16, &counter) && counter <= INT32_MAX;
+      if (ok) conf.probe_counter = (int)counter;
+    } else if (strncmp(arg, "--report=", 9) == 0) {
+      dump = arg + 9;
+      ok = *dump != '\0';
+    } else if (strcmp(arg, "--compress") == 0) {
+      conf.compress = 1;
+    } else if (strcmp(arg, "--stats") == 0) {
+      print_stats = 1;
+    } else if (strcmp(arg, "--help") == 0) {
+      usage(stdout);
+      status = 0;
+      goto done;
+    } else if (arg[0] != '-' && !input) {
+      input = arg;
+    } else {
+      ok = 0;
+    }
+
+    if (!ok) {
+      fprintf(stderr, "cop: invalid argument '%s'\n", arg);
+      usage(stderr);
+      goto done;
+    }
+  }
+
+  if (dump && input) {
+    status = report(input, dump);
+    goto done;
+  }
+  if (!input || !output) {
+    usage(stderr);
+    goto done;
+  }
+  conf.roots = roots;
+  conf.root_count = root_count;
+  conf.probes = probes;
+  conf.probe_count = probe_count;
 
   // Load Object
+  coil_object_t src;
+  coil_err_t err = coil_object_load_file(&src, input);
+  if (err != COIL_ERR_GOOD) {
+    fprintf(stderr, "cop: failed to load '%s'\n", input);
+    goto done;
+  }
 
   // Create Output Object
+  coil_object_t dest;
+  err = coil_object_init(&dest);
+  if (err != COIL_ERR_GOOD) {
+    coil_object_cleanup(&src);
+    goto done;
+  }
 
-  // Load symbols, strings, etc... into COIL output object
-
+  // Load sections, symbols and their names into COIL output object
   // Process each COIL section into native output object section
+  // without statistics no extra measurements are taken
+  err = cop_process(&dest, &src, &conf, print_stats ? &stats : NULL);
+  if (err == COIL_ERR_GOOD) err = coil_object_save_file(&dest, output);
+  if (err != COIL_ERR_GOOD) fprintf(stderr, "cop: failed to process '%s'\n", input);
+
+  if (print_stats) cop_stats_print(stderr, &stats);
 
   // Cleanup
+  coil_object_cleanup(&dest);
+  coil_object_cleanup(&src);
+  status = err == COIL_ERR_GOOD ? 0 : 1;
 
-  return 0;
-}
\ No newline at end of file
+done:
+  free(roots);
+  free(probes);
+  return status;
+}
@@ -19,8 +19,43 @@ extern "C" {
 */
 typedef coil_err_t (*cop_codegen_ft)(coil_object_t *obj, coil_section_header_t *header, coil_section_t *sect);
 
+/**
+* @brief State shared with every generator while a section is lowered
+*
+* Set up by cop_process before a generator is called, generators read the
+* COIL IR from their section argument and emit into native.
+*/
+typedef struct cop_codegen_state_s {
+  const cop_config_t *conf;     ///< Options for this run
+  cop_stats_t *stats;           ///< Statistics to accumulate into, never NULL
+  int measure;                  ///< Statistics were requested, take measurements that cost extra work
+  coil_u64_t symbol_base;       ///< Destination index of the first source symbol
+  coil_section_t *native;       ///< Native section being emitted
+  coil_u32_t section_align;     ///< Alignment of native, padding can align no further
+  coil_size_t align_used;       ///< Alignment padding counted against the budget so far, the function entry included
+  int probe;                    ///< The section being lowered gets probes
+  coil_u64_t probe_symbol;      ///< Destination symbol at the start of the counter section
+  coil_size_t probe_record;     ///< Offset of the counter record of the section being lowered
+} cop_codegen_state_t;
+
+/**
+* @brief Generator state for the section currently being lowered
+*/
+extern cop_codegen_state_t cop_codegen_state;
+
+/**
+* @brief Destination index of a source symbol
+*
+* @param symbol Source symbol index
+*
+* @return coil_u64_t Index of the same symbol in the destination object
+*/
+static inline coil_u64_t cop_codegen_symbol(coil_u64_t symbol) {
+  return cop_codegen_state.symbol_base + symbol;
+}
+
 #ifdef __cplusplus
 }
 #endif
 
-#endif /* __COP_INCLUDE_GUARD_CODEGEN_H */
\ No newline at end of file
+#endif /* __COP_INCLUDE_GUARD_CODEGEN_H */
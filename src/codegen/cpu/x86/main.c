@@ -1,25 +1,146 @@
 #include <src/codegen.h>
+#include <src/ir.h>
+#include <src/profile.h>
+#include <stdlib.h>
+#include <string.h>
 
 extern coil_err_t __cop_codegen_x86   (coil_object_t *obj, coil_section_header_t *header, coil_section_t *sect);
 extern coil_err_t __cop_codegen_x86_32(coil_object_t *obj, coil_section_header_t *header, coil_section_t *sect);
 extern coil_err_t __cop_codegen_x86_64(coil_object_t *obj, coil_section_header_t *header, coil_section_t *sect);
 
-// the higher bit architecture may utilize some previous compilation functions but never the other way around
+typedef coil_err_t (*__x86_align_ft)(coil_section_t *native, coil_u32_t align);
 
-#include "x86_16.h"
+typedef struct __x86_target_s {
+  const cop_codegen_ft *table;                // generators indexed by COIL opcode
+  __x86_align_ft align;                       // padding for loop heads
+  coil_err_t (*enter)(coil_section_t *sect);  // prologue emitted at the function entry, may be NULL
+} __x86_target_t;
 
-coil_err_t __cop_codegen_x86(coil_object_t *obj, coil_section_header_t *header, coil_section_t *sect) {
-  // process each instruction and filter based on opcode into a specific __x86_codegen_comp16_* function
+#include "x86_align.h"
+#include "x86_emit.h"
+#include "x86_probe.h"
+#include "x86_frame.h"
+
+static int __x86_offset_cmp(const void *a, const void *b) {
+  coil_size_t x = *(const coil_size_t *)a, y = *(const coil_size_t *)b;
+  return (x > y) - (x < y);
 }
 
-#include "x86_32.h"
+// Collect the targets of backward br/jmp, sorted and unique
+// *heads is NULL when the section has no loops
+static coil_err_t __x86_codegen_loop_heads(coil_section_t *sect, coil_size_t **heads, coil_size_t *count) {
+  coil_size_t cap = 0;
+  coil_size_t pos = 0;
+  cop_ir_instr_t instr;
+
+  *heads = NULL;
+  *count = 0;
+
+  while (pos < sect->size) {
+    pos = cop_ir_decode(sect, pos, &instr);
+    if (!pos) goto fail;
+
+    coil_size_t target;
+    if (!cop_ir_branch_target(sect, &instr, &target) || target > instr.offset) continue;
+
+    if (*count == cap) {
+      cap = cap ? cap * 2 : 16;
+      coil_size_t *grown = realloc(*heads, cap * sizeof(coil_size_t));
+      if (!grown) {
+        free(*heads);
+        *heads = NULL;
+        return COIL_ERR_NOMEM;
+      }
+      *heads = grown;
+    }
+    (*heads)[(*count)++] = target;
+  }
 
-coil_err_t __cop_codegen_x86_32(coil_object_t *obj, coil_section_header_t *header, coil_section_t *sect) {
-  // process each instruction and filter based on opcode into a specific __x86_codegen_comp32_* function
+  if (*count > 1) {
+    qsort(*heads, *count, sizeof(coil_size_t), __x86_offset_cmp);
+
+    coil_size_t unique = 1;
+    for (coil_size_t i = 1; i < *count; ++i) {
+      if ((*heads)[i] != (*heads)[unique - 1]) (*heads)[unique++] = (*heads)[i];
+    }
+    *count = unique;
+  }
+
+  return COIL_ERR_GOOD;
+fail:
+  free(*heads);
+  *heads = NULL;
+  return coil_error_get_last();
 }
 
-#include "x86_64.h"
+// Lower each instruction of sect for target, padding the loop heads
+static coil_err_t __x86_codegen_section(coil_object_t *obj, coil_section_header_t *header, coil_section_t *sect, const __x86_target_t *target) {
+  const cop_config_t *conf = cop_codegen_state.conf;
+  coil_section_t *native = cop_codegen_state.native;
+  coil_size_t start = native->windex;
+  coil_size_t *heads = NULL;
+  coil_size_t head_count = 0;
+  coil_size_t head = 0;
+  coil_size_t pos = 0;
+  cop_ir_instr_t instr;
+  coil_err_t err;
+
+  if (conf->loop_align > 1 && cop_codegen_state.section_align > 1) {
+    err = __x86_codegen_loop_heads(sect, &heads, &head_count);
+    if (err != COIL_ERR_GOOD) return err;
+  }
+
+  if (target->enter) {
+    err = target->enter(sect);
+    if (err != COIL_ERR_GOOD) goto done;
+  }
+
+  while (pos < sect->size) {
+    pos = cop_ir_decode(sect, pos, &instr);
+    if (!pos) {
+      err = coil_error_get_last();
+      goto done;
+    }
 
-coil_err_t __cop_codegen_x86_64(coil_object_t *obj, coil_section_header_t *header, coil_section_t *sect) {
-  // process each instruction and filter based on opcode into a specific __x86_codegen_comp64_* function
+    if (head < head_count && heads[head] == instr.offset) {
+      err = target->align(native, conf->loop_align);
+      if (err != COIL_ERR_GOOD) goto done;
+      head++;
+    }
+
+    cop_codegen_ft gen = target->table[instr.opcode];
+    if (!gen) {
+      coil_log(COIL_LEVEL_ERROR, "Unsupported opcode for x86: 0x%02x", instr.opcode);
+      err = COIL_ERR_NOTSUP;
+      goto done;
+    }
+
+    err = __x86_move_guard(sect, &instr);
+    if (err != COIL_ERR_GOOD) goto done;
+
+    // generators decode their operands from the read index
+    sect->rindex = instr.operands;
+    err = gen(obj, header, sect);
+    if (err != COIL_ERR_GOOD) goto done;
+  }
+
+  cop_codegen_state.stats->native_bytes += native->windex - start;
+
+done:
+  free(heads);
+  return err;
 }
+
+// one set of generators instantiated per width, see x86_gen.h
+
+#define X86_WIDTH 16
+#define X86_CODEGEN __cop_codegen_x86
+#include "x86_gen.h"
+
+#define X86_WIDTH 32
+#define X86_CODEGEN __cop_codegen_x86_32
+#include "x86_gen.h"
+
+#define X86_WIDTH 64
+#define X86_CODEGEN __cop_codegen_x86_64
+#include "x86_gen.h"
@@ -0,0 +1,72 @@
+// Source Header file, only included once in x86 main.c
+
+// Padding for loop heads, function entries are aligned through the native section alignment set by cop_process.
+// Padding is made of the recommended multi-byte NOPs (0F 1F /0) so it decodes as few instructions as possible.
+// 16 bit code may run on processors before the P6 where 0F 1F is undefined and 66 needs a 386, so it pads with 90 only.
+
+#define X86_NOP_MAX16 1
+#define X86_NOP_MAX32 9
+
+// Indexed by length - 1
+static const coil_byte_t __x86_nop16[X86_NOP_MAX16][X86_NOP_MAX16] = {
+  {0x90},                                                 // nop
+};
+static const coil_byte_t __x86_nop32[X86_NOP_MAX32][X86_NOP_MAX32] = {
+  {0x90},                                                 // nop
+  {0x66, 0x90},                                           // xchg ax, ax
+  {0x0F, 0x1F, 0x00},                                     // nop [eax]
+  {0x0F, 0x1F, 0x40, 0x00},                               // nop [eax+0x00]
+  {0x0F, 0x1F, 0x44, 0x00, 0x00},                         // nop [eax+eax*1+0x00]
+  {0x66, 0x0F, 0x1F, 0x44, 0x00, 0x00},                   // nop word [eax+eax*1+0x00]
+  {0x0F, 0x1F, 0x80, 0x00, 0x00, 0x00, 0x00},             // nop [eax+0x00000000]
+  {0x0F, 0x1F, 0x84, 0x00, 0x00, 0x00, 0x00, 0x00},       // nop [eax+eax*1+0x00000000]
+  {0x66, 0x0F, 0x1F, 0x84, 0x00, 0x00, 0x00, 0x00, 0x00}, // nop word [eax+eax*1+0x00000000]
+};
+
+// Write count bytes of NOPs using the longest encodings in nops
+coil_err_t __x86_codegen_nop_fill(coil_section_t *native, coil_size_t count, const coil_byte_t *nops, coil_size_t maxnop) {
+  coil_err_t err;
+
+  while (count) {
+    coil_size_t len = count < maxnop ? count : maxnop;
+    err = coil_section_write(native, (coil_byte_t *)&nops[(len - 1) * maxnop], len, NULL);
+    if (err != COIL_ERR_GOOD) return err;
+    count -= len;
+  }
+
+  return COIL_ERR_GOOD;
+}
+
+// Pad native up to the next multiple of align within the max skip and section budget
+// Offsets are relative to the native section, so align is capped at the alignment of the section
+coil_err_t __x86_codegen_align(coil_section_t *native, coil_u32_t align, const coil_byte_t *nops, coil_size_t maxnop) {
+  const cop_config_t *conf = cop_codegen_state.conf;
+  cop_stats_t *stats = cop_codegen_state.stats;
+
+  if (align > cop_codegen_state.section_align) align = cop_codegen_state.section_align;
+  if (align <= 1) return COIL_ERR_GOOD;
+
+  coil_size_t pad = (align - (native->windex & (align - 1))) & (align - 1);
+  if (pad == 0) return COIL_ERR_GOOD;
+
+  coil_size_t max_skip = conf->align_max_skip ? conf->align_max_skip : align - 1;
+  if (pad > max_skip || (conf->align_budget && cop_codegen_state.align_used + pad > conf->align_budget)) {
+    stats->align_skipped++;
+    return COIL_ERR_GOOD;
+  }
+
+  coil_err_t err = __x86_codegen_nop_fill(native, pad, nops, maxnop);
+  if (err != COIL_ERR_GOOD) return err;
+
+  cop_codegen_state.align_used += pad;
+  stats->align_points++;
+  stats->align_bytes += pad;
+  return COIL_ERR_GOOD;
+}
+
+coil_err_t __x86_codegen_align16(coil_section_t *native, coil_u32_t align) {
+  return __x86_codegen_align(native, align, &__x86_nop16[0][0], X86_NOP_MAX16);
+}
+coil_err_t __x86_codegen_align32(coil_section_t *native, coil_u32_t align) {
+  return __x86_codegen_align(native, align, &__x86_nop32[0][0], X86_NOP_MAX32);
+}
@@ -0,0 +1,152 @@
+// Source Header file, only included once in x86 main.c
+
+// Operand decoding and instruction encoding helpers shared by the generators.
+// COIL register operands hold the x86 register number for x86 targets (rax = 0 ... r15 = 15).
+
+#define X86_RAX 0
+#define X86_RCX 1
+#define X86_RDX 2
+#define X86_RBX 3
+#define X86_RSP 4
+#define X86_RBP 5
+#define X86_RSI 6
+#define X86_RDI 7
+#define X86_R8  8
+#define X86_R9  9
+#define X86_R10 10
+#define X86_R11 11
+#define X86_R12 12
+#define X86_R13 13
+#define X86_R14 14
+#define X86_R15 15
+
+#define X86_REX   0x40
+#define X86_REX_W 0x08
+#define X86_REX_R 0x04
+#define X86_REX_B 0x01
+
+typedef struct __x86_operand_s {
+  coil_operand_header_t header;
+  coil_u64_t value;
+} __x86_operand_t;
+
+// Decode the operand at *pos and advance *pos past it
+coil_err_t __x86_operand_decode(coil_section_t *sect, coil_size_t *pos, __x86_operand_t *op) {
+  *pos = cop_ir_operand(sect, *pos, &op->header, &op->value, NULL);
+  return *pos ? COIL_ERR_GOOD : coil_error_get_last();
+}
+
+int __x86_operand_is_float(const __x86_operand_t *op) {
+  return op->header.value_type == COIL_VAL_F32 || op->header.value_type == COIL_VAL_F64;
+}
+
+coil_err_t __x86_emit(const coil_byte_t *code, coil_size_t size) {
+  return coil_section_write(cop_codegen_state.native, (coil_byte_t *)code, size, NULL);
+}
+
+// mov dst, src (64 bit registers)
+coil_err_t __x86_emit_mov_rr64(coil_u8_t dst, coil_u8_t src) {
+  coil_byte_t code[] = {
+    X86_REX | X86_REX_W | (src & 8 ? X86_REX_R : 0) | (dst & 8 ? X86_REX_B : 0),
+    0x89,
+    0xC0 | ((src & 7) << 3) | (dst & 7),
+  };
+  return __x86_emit(code, sizeof(code));
+}
+
+// xchg a, b (64 bit registers)
+coil_err_t __x86_emit_xchg_rr64(coil_u8_t a, coil_u8_t b) {
+  coil_byte_t code[] = {
+    X86_REX | X86_REX_W | (a & 8 ? X86_REX_R : 0) | (b & 8 ? X86_REX_B : 0),
+    0x87,
+    0xC0 | ((a & 7) << 3) | (b & 7),
+  };
+  return __x86_emit(code, sizeof(code));
+}
+
+// mov dst, imm using the shortest of the zero extending, sign extending and full forms
+coil_err_t __x86_emit_mov_ri64(coil_u8_t dst, coil_u64_t imm) {
+  coil_byte_t code[10];
+  coil_size_t size = 0;
+
+  if (imm <= 0xFFFFFFFFull) {
+    if (dst & 8) code[size++] = X86_REX | X86_REX_B;
+    code[size++] = 0xB8 | (dst & 7);
+    for (int i = 0; i < 4; ++i) code[size++] = (coil_byte_t)(imm >> (i * 8));
+  } else if ((int64_t)imm >= INT32_MIN && (int64_t)imm < 0) {
+    code[size++] = X86_REX | X86_REX_W | (dst & 8 ? X86_REX_B : 0);
+    code[size++] = 0xC7;
+    code[size++] = 0xC0 | (dst & 7);
+    for (int i = 0; i < 4; ++i) code[size++] = (coil_byte_t)(imm >> (i * 8));
+  } else {
+    code[size++] = X86_REX | X86_REX_W | (dst & 8 ? X86_REX_B : 0);
+    code[size++] = 0xB8 | (dst & 7);
+    for (int i = 0; i < 8; ++i) code[size++] = (coil_byte_t)(imm >> (i * 8));
+  }
+
+  return __x86_emit(code, size);
+}
+
+// movq/movd xmm, gpr when to_xmm, otherwise movq/movd gpr, xmm
+coil_err_t __x86_emit_mov_xmm(coil_u8_t xmm, coil_u8_t gpr, int wide, int to_xmm) {
+  coil_byte_t code[5];
+  coil_size_t size = 0;
+  coil_byte_t rex = (wide ? X86_REX_W : 0) | (xmm & 8 ? X86_REX_R : 0) | (gpr & 8 ? X86_REX_B : 0);
+
+  code[size++] = 0x66;
+  if (rex) code[size++] = X86_REX | rex;
+  code[size++] = 0x0F;
+  code[size++] = to_xmm ? 0x6E : 0x7E;
+  code[size++] = 0xC0 | ((xmm & 7) << 3) | (gpr & 7);
+  return __x86_emit(code, size);
+}
+
+coil_err_t __x86_emit_push64(coil_u8_t reg) {
+  coil_byte_t code[] = {X86_REX | X86_REX_B, 0x50 | (reg & 7)};
+  return reg & 8 ? __x86_emit(code, 2) : __x86_emit(code + 1, 1);
+}
+
+coil_err_t __x86_emit_pop64(coil_u8_t reg) {
+  coil_byte_t code[] = {X86_REX | X86_REX_B, 0x58 | (reg & 7)};
+  return reg & 8 ? __x86_emit(code, 2) : __x86_emit(code + 1, 1);
+}
+
+// add rsp, imm when grow is 0, sub rsp, imm otherwise
+coil_err_t __x86_emit_rsp_adjust(coil_u32_t imm, int grow) {
+  coil_byte_t code[7] = {X86_REX | X86_REX_W};
+  coil_size_t size = 1;
+  coil_byte_t modrm = 0xC0 | ((grow ? 5 : 0) << 3) | X86_RSP;
+
+  if (imm <= 127) {
+    code[size++] = 0x83;
+    code[size++] = modrm;
+    code[size++] = (coil_byte_t)imm;
+  } else {
+    code[size++] = 0x81;
+    code[size++] = modrm;
+    for (int i = 0; i < 4; ++i) code[size++] = (coil_byte_t)(imm >> (i * 8));
+  }
+
+  return __x86_emit(code, size);
+}
+
+// opcode followed by a rel32 to symbol, relocated by the linker
+// symbol indexes the symbols of obj, the source object
+coil_err_t __x86_emit_rel32(coil_object_t *obj, const coil_byte_t *opcode, coil_size_t opsize, coil_u64_t symbol) {
+  coil_byte_t rel[4] = {0};
+
+  if (symbol >= obj->symbol_count) {
+    coil_log(COIL_LEVEL_ERROR, "Symbol index out of range: %llu", (unsigned long long)symbol);
+    return COIL_ERR_INVAL;
+  }
+
+  coil_err_t err = __x86_emit(opcode, opsize);
+  if (err != COIL_ERR_GOOD) return err;
+
+  coil_size_t at = cop_codegen_state.native->windex;
+  err = __x86_emit(rel, sizeof(rel));
+  if (err != COIL_ERR_GOOD) return err;
+
+  // the displacement is relative to the end of the instruction
+  return coil_section_add_reloc(cop_codegen_state.native, at, cop_codegen_symbol(symbol), COIL_RELOC_REL32, -4);
+}
@@ -0,0 +1,467 @@
+// Source Header file, only included once in x86 main.c
+
+// System V AMD64 function frames and parameter passing.
+//
+// Each COIL section is a function. Before lowering it the section is scanned once to find out
+//   - if it is a leaf, a leaf has no frame pointer and leaves rsp as the call left it
+//   - which callee saved registers it writes, only those are saved
+//   - the gparam run at its entry, those are moved out of the argument registers right after the prologue
+// Outgoing parameters (sparam) are queued and moved into the argument registers together when the call is lowered,
+// an instruction writing the source register of a queued parameter before the call is rejected.
+// A call right before a ret is lowered to the epilogue and a jmp.
+// Queued moves are done as a parallel move so a value is never overwritten before it is read.
+// In instrument mode the probes of x86_probe.h go before the prologue and after each epilogue.
+//
+// sparam <value> and gparam <dest> take parameters in order, integers and pointers use rdi, rsi, rdx, rcx, r8, r9
+// and floats xmm0-7, floats are held in general purpose registers in COIL. Stack passed parameters are not supported yet.
+// sret <value> and gret <dest> use rax or xmm0.
+
+#define X86_SYSV_INT_ARGS 6
+#define X86_SYSV_SSE_ARGS 8
+#define X86_SYSV_CALLEE_SAVED ((1u << X86_RBX) | (1u << X86_RBP) | (1u << X86_R12) | (1u << X86_R13) | (1u << X86_R14) | (1u << X86_R15))
+
+#define X86_LOC_XMM 16  // move locations 0-15 are general purpose registers, 16-31 are xmm0-15
+#define X86_MOVES_MAX (X86_SYSV_INT_ARGS + X86_SYSV_SSE_ARGS + 1)  // every parameter register and r11 for a call target
+
+static const coil_u8_t __x86_sysv_int_args[X86_SYSV_INT_ARGS] = {X86_RDI, X86_RSI, X86_RDX, X86_RCX, X86_R8, X86_R9};
+
+// Callee saved registers in the order they are pushed
+static const coil_u8_t __x86_sysv_saved[] = {X86_RBX, X86_RBP, X86_R12, X86_R13, X86_R14, X86_R15};
+
+typedef struct __x86_move_s {
+  coil_u8_t dst;        // location
+  coil_u8_t src;        // location, unused for immediates
+  coil_u8_t imm;        // src is value
+  coil_u8_t wide;       // 64 bit float moves
+  coil_u64_t value;
+} __x86_move_t;
+
+typedef struct __x86_frame_s {
+  int leaf;
+  int frame_pointer;    // rbp is pushed and set to the frame
+  int branches;         // the function has local br or jmp, any ret may be a branch target
+  int skip_ret;         // the next ret follows a tail call and is never reached
+  coil_u32_t saved;     // callee saved registers pushed, not including the frame pointer
+  coil_u32_t adjust;    // rsp adjustment after the saved registers
+  coil_size_t entry_end;// offset of the first instruction after the entry gparam run
+  coil_u8_t gparam_int, gparam_sse;
+  coil_u8_t sparam_int, sparam_sse;
+  __x86_move_t moves[X86_MOVES_MAX];
+  coil_u8_t move_count;
+  coil_u32_t move_dsts; // locations written by the queued moves, including moves onto themselves
+} __x86_frame_t;
+
+static __x86_frame_t __x86_frame;
+
+// Queue a move from location src, moves onto themselves are dropped
+static coil_err_t __x86_move_queue_loc(coil_u8_t dst, coil_u8_t src, int wide) {
+  __x86_frame.move_dsts |= 1u << dst;
+  if (src == dst) return COIL_ERR_GOOD;
+  if (__x86_frame.move_count == X86_MOVES_MAX) return COIL_ERR_NOTSUP;
+
+  __x86_move_t *m = &__x86_frame.moves[__x86_frame.move_count++];
+  m->dst = dst;
+  m->src = src;
+  m->imm = 0;
+  m->wide = (coil_u8_t)wide;
+  m->value = 0;
+  return COIL_ERR_GOOD;
+}
+
+// Queue a move from a register or immediate operand
+static coil_err_t __x86_move_queue(coil_u8_t dst, const __x86_operand_t *src, int wide) {
+  if (src->header.type == COIL_TYPEOP_REG) return __x86_move_queue_loc(dst, (coil_u8_t)(src->value & 15), wide);
+
+  if (src->header.type != COIL_TYPEOP_IMM) {
+    coil_log(COIL_LEVEL_ERROR, "Parameters must be registers or immediates");
+    return COIL_ERR_NOTSUP;
+  }
+  if (__x86_frame.move_count == X86_MOVES_MAX) return COIL_ERR_NOTSUP;
+
+  __x86_frame.move_dsts |= 1u << dst;
+  __x86_move_t *m = &__x86_frame.moves[__x86_frame.move_count++];
+  m->dst = dst;
+  m->src = 0;
+  m->imm = 1;
+  m->wide = (coil_u8_t)wide;
+  m->value = src->value;
+  return COIL_ERR_GOOD;
+}
+
+// A caller saved register neither written by the queue nor read by a queued move, 0xFF if there is none
+// Queues are flushed at calls, entries and returns where caller saved registers hold nothing else
+static coil_u8_t __x86_move_scratch(void) {
+  static const coil_u8_t candidates[] = {X86_R11, X86_R10, X86_RAX, X86_RCX, X86_RDX, X86_RSI, X86_RDI, X86_R8, X86_R9};
+
+  for (coil_size_t c = 0; c < sizeof(candidates); ++c) {
+    int used = (__x86_frame.move_dsts >> candidates[c]) & 1;
+    for (coil_u8_t i = 0; i < __x86_frame.move_count && !used; ++i) {
+      const __x86_move_t *m = &__x86_frame.moves[i];
+      used = !m->imm && m->src == candidates[c];
+    }
+    if (!used) return candidates[c];
+  }
+
+  return 0xFF;
+}
+
+static coil_err_t __x86_move_emit(const __x86_move_t *m) {
+  int dst_xmm = m->dst >= X86_LOC_XMM;
+  int src_xmm = !m->imm && m->src >= X86_LOC_XMM;
+
+  if (m->imm && dst_xmm) {
+    coil_u8_t scratch = __x86_move_scratch();
+    if (scratch == 0xFF) {
+      coil_log(COIL_LEVEL_ERROR, "No free register to move a float immediate parameter through");
+      return COIL_ERR_NOTSUP;
+    }
+
+    coil_err_t err = __x86_emit_mov_ri64(scratch, m->value);
+    if (err != COIL_ERR_GOOD) return err;
+    return __x86_emit_mov_xmm(m->dst - X86_LOC_XMM, scratch, m->wide, 1);
+  }
+  if (m->imm) return __x86_emit_mov_ri64(m->dst, m->value);
+  if (dst_xmm) return __x86_emit_mov_xmm(m->dst - X86_LOC_XMM, m->src, m->wide, 1);
+  if (src_xmm) return __x86_emit_mov_xmm(m->src - X86_LOC_XMM, m->dst, m->wide, 0);
+  return __x86_emit_mov_rr64(m->dst, m->src);
+}
+
+// Index of a queued move reading loc, move_count if there is none
+static coil_u8_t __x86_move_reader(coil_u8_t loc, coil_u8_t skip) {
+  for (coil_u8_t j = 0; j < __x86_frame.move_count; ++j) {
+    if (j != skip && !__x86_frame.moves[j].imm && __x86_frame.moves[j].src == loc) return j;
+  }
+  return __x86_frame.move_count;
+}
+
+// Emit the queued moves, a move goes once no other queued move reads its destination
+// Cycles are broken with xchg
+static coil_err_t __x86_move_flush(void) {
+  coil_err_t err;
+
+  while (__x86_frame.move_count) {
+    coil_u8_t ready = __x86_frame.move_count;
+    for (coil_u8_t i = 0; i < __x86_frame.move_count; ++i) {
+      const __x86_move_t *m = &__x86_frame.moves[i];
+      if (__x86_move_reader(m->dst, i) < __x86_frame.move_count) continue;
+
+      // float immediates go last, once the other sources are read their registers are free scratch
+      ready = i;
+      if (!m->imm || m->dst < X86_LOC_XMM) break;
+    }
+
+    if (ready == __x86_frame.move_count) {
+      // every destination is still read, following readers from any move ends up in a cycle
+      // of general purpose register moves, only those can read a destination
+      coil_u8_t i = 0;
+      for (coil_u8_t n = 0; n < __x86_frame.move_count; ++n) i = __x86_move_reader(__x86_frame.moves[i].dst, i);
+
+      // swapping completes move i, whatever read either register now reads the other
+      coil_u8_t a = __x86_frame.moves[i].dst;
+      coil_u8_t b = __x86_frame.moves[i].src;
+      err = __x86_emit_xchg_rr64(a, b);
+      if (err != COIL_ERR_GOOD) return err;
+
+      __x86_frame.moves[i] = __x86_frame.moves[--__x86_frame.move_count];
+      for (coil_u8_t j = 0; j < __x86_frame.move_count; ++j) {
+        __x86_move_t *m = &__x86_frame.moves[j];
+        if (m->imm) continue;
+        if (m->src == a) m->src = b;
+        else if (m->src == b) m->src = a;
+      }
+      continue;
+    }
+
+    err = __x86_move_emit(&__x86_frame.moves[ready]);
+    if (err != COIL_ERR_GOOD) return err;
+    __x86_frame.moves[ready] = __x86_frame.moves[--__x86_frame.move_count];
+  }
+
+  __x86_frame.move_dsts = 0;
+  return COIL_ERR_GOOD;
+}
+
+// Emit a single move from location src right away, queued moves are left for the next flush
+static coil_err_t __x86_move_now_loc(coil_u8_t dst, coil_u8_t src, int wide) {
+  __x86_move_t m = {dst, src, 0, (coil_u8_t)wide, 0};
+  if (src == dst) return COIL_ERR_GOOD;
+  return __x86_move_emit(&m);
+}
+
+// Emit a single move from a register or immediate operand right away
+static coil_err_t __x86_move_now(coil_u8_t dst, const __x86_operand_t *src, int wide) {
+  if (src->header.type == COIL_TYPEOP_REG) return __x86_move_now_loc(dst, (coil_u8_t)(src->value & 15), wide);
+
+  if (src->header.type != COIL_TYPEOP_IMM) {
+    coil_log(COIL_LEVEL_ERROR, "Parameters must be registers or immediates");
+    return COIL_ERR_NOTSUP;
+  }
+
+  __x86_move_t m = {dst, 0, 1, (coil_u8_t)wide, src->value};
+  return __x86_move_emit(&m);
+}
+
+// Registers written by an instruction besides its first operand
+static coil_u32_t __x86_implicit_writes(coil_u8_t opcode) {
+  switch (opcode) {
+    case COIL_OP_CPUID: return (1u << X86_RAX) | (1u << X86_RBX) | (1u << X86_RCX) | (1u << X86_RDX);
+    case COIL_OP_RDTSC: case COIL_OP_RDMSR: case COIL_OP_RDPMC: return (1u << X86_RAX) | (1u << X86_RDX);
+    case COIL_OP_SRET: return 1u << X86_RAX;
+    default: return 0;
+  }
+}
+
+// Queued moves read their source registers when the call is lowered, so an instruction between
+// sparam and call must not write one of them
+static coil_err_t __x86_move_guard(coil_section_t *sect, const cop_ir_instr_t *instr) {
+  if (!__x86_frame.move_count) return COIL_ERR_GOOD;
+
+  coil_u32_t written = __x86_implicit_writes(instr->opcode);
+  if (cop_ir_writes(instr->opcode) && instr->operand_count) {
+    coil_size_t pos = instr->operands;
+    __x86_operand_t dst;
+
+    coil_err_t err = __x86_operand_decode(sect, &pos, &dst);
+    if (err != COIL_ERR_GOOD) return err;
+    if (dst.header.type == COIL_TYPEOP_REG) written |= 1u << (dst.value & 15);
+  }
+
+  for (coil_u8_t i = 0; i < __x86_frame.move_count; ++i) {
+    const __x86_move_t *m = &__x86_frame.moves[i];
+    if (m->imm || m->src >= X86_LOC_XMM || !(written & (1u << m->src))) continue;
+
+    coil_log(COIL_LEVEL_ERROR, "Parameter register %u is written before the call at 0x%zx", m->src, (size_t)instr->offset);
+    return COIL_ERR_NOTSUP;
+  }
+
+  return COIL_ERR_GOOD;
+}
+
+// Location of the next parameter of the given class, 0xFF once the class runs out of registers
+static coil_u8_t __x86_param_loc(coil_u8_t *next_int, coil_u8_t *next_sse, int is_float) {
+  if (is_float) return *next_sse < X86_SYSV_SSE_ARGS ? X86_LOC_XMM + (*next_sse)++ : 0xFF;
+  return *next_int < X86_SYSV_INT_ARGS ? __x86_sysv_int_args[(*next_int)++] : 0xFF;
+}
+
+// Scan sect and queue the entry gparam moves
+static coil_err_t __x86_frame_plan(coil_section_t *sect) {
+  coil_size_t pos = 0;
+  int entry = 1;
+  cop_ir_instr_t instr;
+  coil_err_t err;
+
+  memset(&__x86_frame, 0, sizeof(__x86_frame));
+  __x86_frame.leaf = 1;
+
+  while (pos < sect->size) {
+    pos = cop_ir_decode(sect, pos, &instr);
+    if (!pos) return coil_error_get_last();
+
+    coil_size_t target;
+    if (instr.opcode == COIL_OP_CALL) __x86_frame.leaf = 0;
+    if (cop_ir_branch_target(sect, &instr, &target)) __x86_frame.branches = 1;
+    if (instr.opcode == COIL_OP_CPUID) __x86_frame.saved |= 1u << X86_RBX;
+
+    if (instr.opcode != COIL_OP_GPARAM) entry = 0;
+    if (!cop_ir_writes(instr.opcode) || !instr.operand_count) continue;
+
+    coil_size_t oppos = instr.operands;
+    __x86_operand_t dst;
+    err = __x86_operand_decode(sect, &oppos, &dst);
+    if (err != COIL_ERR_GOOD) return err;
+    if (dst.header.type != COIL_TYPEOP_REG) continue;
+
+    coil_u8_t reg = (coil_u8_t)(dst.value & 15);
+    __x86_frame.saved |= (1u << reg) & X86_SYSV_CALLEE_SAVED;
+
+    if (entry) {
+      coil_u8_t loc = __x86_param_loc(&__x86_frame.gparam_int, &__x86_frame.gparam_sse, __x86_operand_is_float(&dst));
+      if (loc == 0xFF) {
+        coil_log(COIL_LEVEL_ERROR, "Stack passed parameters are not supported");
+        return COIL_ERR_NOTSUP;
+      }
+
+      err = __x86_move_queue_loc(reg, loc, dst.header.value_type == COIL_VAL_F64);
+      if (err != COIL_ERR_GOOD) return err;
+      __x86_frame.entry_end = instr.next;
+    }
+  }
+
+  return COIL_ERR_GOOD;
+}
+
+// Plan the frame of sect and emit its prologue
+coil_err_t __x86_frame_enter(coil_section_t *sect) {
+  cop_stats_t *stats = cop_codegen_state.stats;
+  coil_u32_t pushed = 1; // return address
+  coil_err_t err;
+
+  err = __x86_frame_plan(sect);
+  if (err != COIL_ERR_GOOD) return err;
+
+  if (cop_codegen_state.probe) {
+    err = __x86_probe_enter();
+    if (err != COIL_ERR_GOOD) return err;
+  }
+
+  if (!__x86_frame.leaf) {
+    __x86_frame.frame_pointer = 1;
+    __x86_frame.saved &= ~(1u << X86_RBP);
+
+    coil_byte_t mov_rbp_rsp[] = {X86_REX | X86_REX_W, 0x89, 0xE5};
+    err = __x86_emit_push64(X86_RBP);
+    if (err == COIL_ERR_GOOD) err = __x86_emit(mov_rbp_rsp, sizeof(mov_rbp_rsp));
+    if (err != COIL_ERR_GOOD) return err;
+    pushed++;
+  }
+
+  for (coil_size_t i = 0; i < sizeof(__x86_sysv_saved); ++i) {
+    if (!(__x86_frame.saved & (1u << __x86_sysv_saved[i]))) continue;
+    err = __x86_emit_push64(__x86_sysv_saved[i]);
+    if (err != COIL_ERR_GOOD) return err;
+    pushed++;
+    stats->saved_regs++;
+  }
+
+  // functions that call keep rsp 16 byte aligned for their calls
+  if (!__x86_frame.leaf && (pushed * 8) % 16) __x86_frame.adjust = 8;
+  if (__x86_frame.adjust) {
+    err = __x86_emit_rsp_adjust(__x86_frame.adjust, 1);
+    if (err != COIL_ERR_GOOD) return err;
+  }
+
+  if (__x86_frame.leaf) stats->leaf_functions++;
+  if (pushed == 1 && !__x86_frame.adjust) stats->frameless++;
+
+  return __x86_move_flush();
+}
+
+// Emit the epilogue, everything up to the ret or tail jmp
+coil_err_t __x86_frame_leave(void) {
+  coil_err_t err;
+
+  if (__x86_frame.adjust) {
+    err = __x86_emit_rsp_adjust(__x86_frame.adjust, 0);
+    if (err != COIL_ERR_GOOD) return err;
+  }
+
+  for (coil_size_t i = sizeof(__x86_sysv_saved); i-- > 0;) {
+    if (!(__x86_frame.saved & (1u << __x86_sysv_saved[i]))) continue;
+    err = __x86_emit_pop64(__x86_sysv_saved[i]);
+    if (err != COIL_ERR_GOOD) return err;
+  }
+
+  if (__x86_frame.frame_pointer) {
+    err = __x86_emit_pop64(X86_RBP);
+    if (err != COIL_ERR_GOOD) return err;
+  }
+
+  if (cop_codegen_state.probe) return __x86_probe_leave();
+  return COIL_ERR_GOOD;
+}
+
+// Lower call, a call right before a ret is lowered to a jmp after the epilogue
+// The ret is dropped unless a branch may reach it
+coil_err_t __x86_frame_call(coil_object_t *obj, coil_section_t *sect) {
+  cop_ir_instr_t next = {0};
+  coil_size_t pos = sect->rindex;
+  __x86_operand_t target;
+  coil_err_t err;
+
+  err = __x86_operand_decode(sect, &pos, &target);
+  if (err != COIL_ERR_GOOD) return err;
+  if (pos < sect->size && !cop_ir_decode(sect, pos, &next)) return coil_error_get_last();
+  int tail = pos < sect->size && next.opcode == COIL_OP_RET;
+
+  // a register target goes through r11 with the parameters, so neither the parameter moves
+  // nor the epilogue of a tail call can overwrite it, r11 is never a parameter or callee saved
+  if (target.header.type == COIL_TYPEOP_REG) {
+    err = __x86_move_queue_loc(X86_R11, (coil_u8_t)(target.value & 15), 0);
+    if (err != COIL_ERR_GOOD) return err;
+  }
+
+  // move the outgoing parameters into place
+  __x86_frame.sparam_int = 0;
+  __x86_frame.sparam_sse = 0;
+  err = __x86_move_flush();
+  if (err != COIL_ERR_GOOD) return err;
+
+  if (tail) {
+    err = __x86_frame_leave();
+    if (err != COIL_ERR_GOOD) return err;
+    __x86_frame.skip_ret = !__x86_frame.branches;
+    cop_codegen_state.stats->tail_calls++;
+  }
+
+  if (target.header.type == COIL_TYPEOP_SYM) {
+    coil_byte_t op = tail ? 0xE9 : 0xE8; // jmp rel32 / call rel32
+    return __x86_emit_rel32(obj, &op, 1, target.value);
+  }
+  if (target.header.type == COIL_TYPEOP_REG) {
+    coil_byte_t code[] = {X86_REX | X86_REX_B, 0xFF, 0xC0 | ((tail ? 4 : 2) << 3) | (X86_R11 & 7)}; // jmp r11 / call r11
+    return __x86_emit(code, sizeof(code));
+  }
+
+  coil_log(COIL_LEVEL_ERROR, "Unsupported call target operand");
+  return COIL_ERR_NOTSUP;
+}
+
+coil_err_t __x86_frame_sparam(coil_section_t *sect) {
+  coil_size_t pos = sect->rindex;
+  __x86_operand_t value;
+
+  coil_err_t err = __x86_operand_decode(sect, &pos, &value);
+  if (err != COIL_ERR_GOOD) return err;
+
+  coil_u8_t loc = __x86_param_loc(&__x86_frame.sparam_int, &__x86_frame.sparam_sse, __x86_operand_is_float(&value));
+  if (loc == 0xFF) {
+    coil_log(COIL_LEVEL_ERROR, "Stack passed parameters are not supported");
+    return COIL_ERR_NOTSUP;
+  }
+
+  return __x86_move_queue(loc, &value, value.header.value_type == COIL_VAL_F64);
+}
+
+coil_err_t __x86_frame_gparam(coil_section_t *sect) {
+  coil_size_t pos = sect->rindex;
+  __x86_operand_t dst;
+
+  // the entry run was moved by the prologue
+  if (pos < __x86_frame.entry_end) return COIL_ERR_GOOD;
+
+  coil_err_t err = __x86_operand_decode(sect, &pos, &dst);
+  if (err != COIL_ERR_GOOD) return err;
+  if (dst.header.type != COIL_TYPEOP_REG) return COIL_ERR_NOTSUP;
+
+  coil_u8_t loc = __x86_param_loc(&__x86_frame.gparam_int, &__x86_frame.gparam_sse, __x86_operand_is_float(&dst));
+  if (loc == 0xFF) {
+    coil_log(COIL_LEVEL_ERROR, "Stack passed parameters are not supported");
+    return COIL_ERR_NOTSUP;
+  }
+
+  // later gparams read whatever is left in the argument register
+  return __x86_move_now_loc((coil_u8_t)(dst.value & 15), loc, dst.header.value_type == COIL_VAL_F64);
+}
+
+coil_err_t __x86_frame_sret(coil_section_t *sect) {
+  coil_size_t pos = sect->rindex;
+  __x86_operand_t value;
+
+  coil_err_t err = __x86_operand_decode(sect, &pos, &value);
+  if (err != COIL_ERR_GOOD) return err;
+
+  coil_u8_t loc = __x86_operand_is_float(&value) ? X86_LOC_XMM : X86_RAX;
+  return __x86_move_now(loc, &value, value.header.value_type == COIL_VAL_F64);
+}
+
+coil_err_t __x86_frame_gret(coil_section_t *sect) {
+  coil_size_t pos = sect->rindex;
+  __x86_operand_t dst;
+
+  coil_err_t err = __x86_operand_decode(sect, &pos, &dst);
+  if (err != COIL_ERR_GOOD) return err;
+  if (dst.header.type != COIL_TYPEOP_REG) return COIL_ERR_NOTSUP;
+
+  coil_u8_t loc = __x86_operand_is_float(&dst) ? X86_LOC_XMM : X86_RAX;
+  return __x86_move_now_loc((coil_u8_t)(dst.value & 15), loc, dst.header.value_type == COIL_VAL_F64);
+}
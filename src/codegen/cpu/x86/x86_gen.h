@@ -0,0 +1,342 @@
+// Source Header file, included once per target width in x86 main.c
+
+// Generators for every x86 width. Before each include main.c defines
+//   X86_WIDTH    16, 32 or 64
+//   X86_CODEGEN  name of the generator entry point for that width
+// and this file instantiates __x86_codegen_compNN_* handlers, their table and the entry point.
+// Width specific encodings are picked with X86_WIDTH at compile time so no handler branches on the width
+// when it runs. Everything defined here is undefined again at the end of the file.
+
+// Each function will need to find out the type operands then construct the corresponding instructions for the functionality.
+// since 64 bit integers are supported instructions may have to compile into multiple instructions with higher and lower
+// like add lower 16 add higher 16 for 32 bit addition or extended for 64 bit integers.
+// this emulation is not supported with floats as of yet, this is a more complex task and will be completed in the future.
+// floats don't have to be supported at all.
+
+#define X86_GEN_PASTE(width, name) __x86_codegen_comp##width##_##name
+#define X86_GEN_EXPAND(width, name) X86_GEN_PASTE(width, name)
+#define X86_GEN(name) X86_GEN_EXPAND(X86_WIDTH, name)
+#define X86_HANDLER(name) coil_err_t X86_GEN(name)(coil_object_t *obj, coil_section_header_t *header, coil_section_t *sect)
+
+#if X86_WIDTH == 16
+#define X86_NOPS (&__x86_nop16[0][0])
+#define X86_NOP_MAX X86_NOP_MAX16
+#define X86_ALIGN __x86_codegen_align16
+#elif X86_WIDTH == 32 || X86_WIDTH == 64
+#define X86_NOPS (&__x86_nop32[0][0])
+#define X86_NOP_MAX X86_NOP_MAX32
+#define X86_ALIGN __x86_codegen_align32
+#else
+#error "X86_WIDTH must be 16, 32 or 64"
+#endif
+
+// System V frames are only lowered for 64 bit
+#if X86_WIDTH == 64
+#define X86_ENTER __x86_frame_enter
+#else
+#define X86_ENTER NULL
+#endif
+
+// Control Flow Operations
+X86_HANDLER(nop) {
+  return __x86_codegen_nop_fill(cop_codegen_state.native, 1, X86_NOPS, X86_NOP_MAX);
+}
+X86_HANDLER(br) {
+
+  return COIL_ERR_GOOD;
+}
+X86_HANDLER(jmp) {
+
+  return COIL_ERR_GOOD;
+}
+X86_HANDLER(call) {
+#if X86_WIDTH == 64
+  return __x86_frame_call(obj, sect);
+#else
+  return COIL_ERR_GOOD;
+#endif
+}
+X86_HANDLER(ret) {
+  coil_byte_t ret = 0xC3;
+#if X86_WIDTH == 64
+  if (__x86_frame.skip_ret) {
+    __x86_frame.skip_ret = 0;
+    return COIL_ERR_GOOD;
+  }
+
+  coil_err_t err = __x86_frame_leave();
+  if (err != COIL_ERR_GOOD) return err;
+#endif
+  return __x86_emit(&ret, 1);
+}
+X86_HANDLER(cmp) {
+
+  return COIL_ERR_GOOD;
+}
+X86_HANDLER(test) {
+
+  return COIL_ERR_GOOD;
+}
+
+// Memory Operations
+X86_HANDLER(mov) {
+
+  return COIL_ERR_GOOD;
+}
+X86_HANDLER(push) {
+
+  return COIL_ERR_GOOD;
+}
+X86_HANDLER(pop) {
+
+  return COIL_ERR_GOOD;
+}
+X86_HANDLER(lea) {
+
+  return COIL_ERR_GOOD;
+}
+
+// Arithmetic Operations
+X86_HANDLER(add) {
+
+  return COIL_ERR_GOOD;
+}
+X86_HANDLER(sub) {
+
+  return COIL_ERR_GOOD;
+}
+X86_HANDLER(mul) {
+
+  return COIL_ERR_GOOD;
+}
+X86_HANDLER(div) {
+
+  return COIL_ERR_GOOD;
+}
+X86_HANDLER(mod) {
+
+  return COIL_ERR_GOOD;
+}
+X86_HANDLER(inc) {
+
+  return COIL_ERR_GOOD;
+}
+X86_HANDLER(dec) {
+
+  return COIL_ERR_GOOD;
+}
+X86_HANDLER(neg) {
+
+  return COIL_ERR_GOOD;
+}
+
+// Control Flow Operations
+X86_HANDLER(and) {
+
+  return COIL_ERR_GOOD;
+}
+X86_HANDLER(or) {
+
+  return COIL_ERR_GOOD;
+}
+X86_HANDLER(xor) {
+
+  return COIL_ERR_GOOD;
+}
+X86_HANDLER(not) {
+
+  return COIL_ERR_GOOD;
+}
+X86_HANDLER(shl) {
+
+  return COIL_ERR_GOOD;
+}
+X86_HANDLER(shr) {
+
+  return COIL_ERR_GOOD;
+}
+X86_HANDLER(sal) {
+
+  return COIL_ERR_GOOD;
+}
+X86_HANDLER(sar) {
+
+  return COIL_ERR_GOOD;
+}
+
+// Type Operations
+X86_HANDLER(cvt) {
+
+  return COIL_ERR_GOOD;
+}
+
+// PU Operations
+X86_HANDLER(int) {
+
+  return COIL_ERR_GOOD;
+}
+X86_HANDLER(iret) {
+#if X86_WIDTH == 64
+  coil_byte_t iret[] = {X86_REX | X86_REX_W, 0xCF}; // iretq, a bare CF would pop a 32 bit frame
+#else
+  coil_byte_t iret[] = {0xCF};
+#endif
+  return __x86_emit(iret, sizeof(iret));
+}
+X86_HANDLER(cli) {
+  coil_byte_t cli = 0xFA;
+  return __x86_emit(&cli, 1);
+}
+X86_HANDLER(sti) {
+  coil_byte_t sti = 0xFB;
+  return __x86_emit(&sti, 1);
+}
+X86_HANDLER(syscall) {
+  // Encode int with 0x80
+  return COIL_ERR_GOOD;
+}
+X86_HANDLER(sysret) {
+#if X86_WIDTH == 16
+  return X86_GEN(iret)(obj, header, sect);
+#elif X86_WIDTH == 64
+  coil_byte_t sysret[] = {X86_REX | X86_REX_W, 0x0F, 0x07}; // sysretq, returns to 64 bit code
+  return __x86_emit(sysret, sizeof(sysret));
+#else
+  // sysret is #UD in 32 bit protected mode on Intel, there is no encoding that works everywhere
+  return COIL_ERR_GOOD;
+#endif
+}
+X86_HANDLER(rdtsc) {
+
+  return COIL_ERR_GOOD;
+}
+
+// Arch Operations
+X86_HANDLER(cpuid) {
+
+  return COIL_ERR_GOOD;
+}
+X86_HANDLER(rdmsr) {
+
+  return COIL_ERR_GOOD;
+}
+X86_HANDLER(wrmsr) {
+
+  return COIL_ERR_GOOD;
+}
+X86_HANDLER(lgdt) {
+
+  return COIL_ERR_GOOD;
+}
+X86_HANDLER(sgdt) {
+
+  return COIL_ERR_GOOD;
+}
+X86_HANDLER(lidt) {
+
+  return COIL_ERR_GOOD;
+}
+X86_HANDLER(sidt) {
+
+  return COIL_ERR_GOOD;
+}
+X86_HANDLER(rdpmc) {
+
+  return COIL_ERR_GOOD;
+}
+
+// Directive Operations
+X86_HANDLER(sparam) {
+#if X86_WIDTH == 64
+  return __x86_frame_sparam(sect);
+#else
+  return COIL_ERR_GOOD;
+#endif
+}
+X86_HANDLER(gparam) {
+#if X86_WIDTH == 64
+  return __x86_frame_gparam(sect);
+#else
+  return COIL_ERR_GOOD;
+#endif
+}
+X86_HANDLER(sret) {
+#if X86_WIDTH == 64
+  return __x86_frame_sret(sect);
+#else
+  return COIL_ERR_GOOD;
+#endif
+}
+X86_HANDLER(gret) {
+#if X86_WIDTH == 64
+  return __x86_frame_gret(sect);
+#else
+  return COIL_ERR_GOOD;
+#endif
+}
+
+static const cop_codegen_ft X86_GEN(table)[256] = {
+  [COIL_OP_NOP]     = X86_GEN(nop),
+  [COIL_OP_BR]      = X86_GEN(br),
+  [COIL_OP_JMP]     = X86_GEN(jmp),
+  [COIL_OP_CALL]    = X86_GEN(call),
+  [COIL_OP_RET]     = X86_GEN(ret),
+  [COIL_OP_CMP]     = X86_GEN(cmp),
+  [COIL_OP_TEST]    = X86_GEN(test),
+  [COIL_OP_MOV]     = X86_GEN(mov),
+  [COIL_OP_PUSH]    = X86_GEN(push),
+  [COIL_OP_POP]     = X86_GEN(pop),
+  [COIL_OP_LEA]     = X86_GEN(lea),
+  [COIL_OP_ADD]     = X86_GEN(add),
+  [COIL_OP_SUB]     = X86_GEN(sub),
+  [COIL_OP_MUL]     = X86_GEN(mul),
+  [COIL_OP_DIV]     = X86_GEN(div),
+  [COIL_OP_MOD]     = X86_GEN(mod),
+  [COIL_OP_INC]     = X86_GEN(inc),
+  [COIL_OP_DEC]     = X86_GEN(dec),
+  [COIL_OP_NEG]     = X86_GEN(neg),
+  [COIL_OP_AND]     = X86_GEN(and),
+  [COIL_OP_OR]      = X86_GEN(or),
+  [COIL_OP_XOR]     = X86_GEN(xor),
+  [COIL_OP_NOT]     = X86_GEN(not),
+  [COIL_OP_SHL]     = X86_GEN(shl),
+  [COIL_OP_SHR]     = X86_GEN(shr),
+  [COIL_OP_SAL]     = X86_GEN(sal),
+  [COIL_OP_SAR]     = X86_GEN(sar),
+  [COIL_OP_CVT]     = X86_GEN(cvt),
+  [COIL_OP_INT]     = X86_GEN(int),
+  [COIL_OP_IRET]    = X86_GEN(iret),
+  [COIL_OP_CLI]     = X86_GEN(cli),
+  [COIL_OP_STI]     = X86_GEN(sti),
+  [COIL_OP_SYSCALL] = X86_GEN(syscall),
+  [COIL_OP_SYSRET]  = X86_GEN(sysret),
+  [COIL_OP_RDTSC]   = X86_GEN(rdtsc),
+  [COIL_OP_CPUID]   = X86_GEN(cpuid),
+  [COIL_OP_RDMSR]   = X86_GEN(rdmsr),
+  [COIL_OP_WRMSR]   = X86_GEN(wrmsr),
+  [COIL_OP_LGDT]    = X86_GEN(lgdt),
+  [COIL_OP_SGDT]    = X86_GEN(sgdt),
+  [COIL_OP_LIDT]    = X86_GEN(lidt),
+  [COIL_OP_SIDT]    = X86_GEN(sidt),
+  [COIL_OP_RDPMC]   = X86_GEN(rdpmc),
+  [COIL_OP_SPARAM]  = X86_GEN(sparam),
+  [COIL_OP_GPARAM]  = X86_GEN(gparam),
+  [COIL_OP_SRET]    = X86_GEN(sret),
+  [COIL_OP_GRET]    = X86_GEN(gret),
+};
+static const __x86_target_t X86_GEN(target) = {X86_GEN(table), X86_ALIGN, X86_ENTER};
+
+coil_err_t X86_CODEGEN(coil_object_t *obj, coil_section_header_t *header, coil_section_t *sect) {
+  return __x86_codegen_section(obj, header, sect, &X86_GEN(target));
+}
+
+#undef X86_GEN_PASTE
+#undef X86_GEN_EXPAND
+#undef X86_GEN
+#undef X86_HANDLER
+#undef X86_NOPS
+#undef X86_NOP_MAX
+#undef X86_ALIGN
+#undef X86_ENTER
+#undef X86_WIDTH
+#undef X86_CODEGEN
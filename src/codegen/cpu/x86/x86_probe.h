@@ -0,0 +1,81 @@
+// Source Header file, only included once in x86 main.c
+
+// Cycle counter probes for instrument mode, the counter records are described in src/profile.h.
+// The entry probe sits before the prologue and the exit probe after the epilogue, where argument and
+// return registers are live, so probes save every register they use. Flags are dead at both points.
+// Counters are updated without lock, concurrent calls of one function may lose counts.
+
+// op [rip + field of the counter record], rax
+static coil_err_t __x86_probe_update(const coil_byte_t *code, coil_size_t size, coil_size_t field) {
+  coil_byte_t disp[4] = {0};
+
+  coil_err_t err = __x86_emit(code, size);
+  if (err != COIL_ERR_GOOD) return err;
+
+  coil_size_t at = cop_codegen_state.native->windex;
+  err = __x86_emit(disp, sizeof(disp));
+  if (err != COIL_ERR_GOOD) return err;
+
+  // the displacement is relative to the end of the instruction
+  return coil_section_add_reloc(cop_codegen_state.native, at, cop_codegen_state.probe_symbol,
+    COIL_RELOC_REL32, (int64_t)(cop_codegen_state.probe_record + field) - 4);
+}
+
+// Save rax and rdx and read the counter into rax
+static coil_err_t __x86_probe_read(void) {
+  int counter = cop_codegen_state.conf->probe_counter;
+  coil_err_t err;
+
+  err = __x86_emit_push64(X86_RAX);
+  if (err == COIL_ERR_GOOD) err = __x86_emit_push64(X86_RDX);
+  if (err != COIL_ERR_GOOD) return err;
+
+  if (counter < 0) {
+    coil_byte_t rdtsc[] = {0x0F, 0x31};
+    err = __x86_emit(rdtsc, sizeof(rdtsc));
+  } else {
+    coil_byte_t rdpmc[] = {0xB9, 0, 0, 0, 0, 0x0F, 0x33}; // mov ecx, counter; rdpmc
+    for (int i = 0; i < 4; ++i) rdpmc[1 + i] = (coil_byte_t)((coil_u32_t)counter >> (i * 8));
+    err = __x86_emit_push64(X86_RCX);
+    if (err == COIL_ERR_GOOD) err = __x86_emit(rdpmc, sizeof(rdpmc));
+  }
+  if (err != COIL_ERR_GOOD) return err;
+
+  coil_byte_t combine[] = {
+    X86_REX | X86_REX_W, 0xC1, 0xE2, 0x20,  // shl rdx, 32
+    X86_REX | X86_REX_W, 0x09, 0xD0,        // or rax, rdx
+  };
+  return __x86_emit(combine, sizeof(combine));
+}
+
+// Restore the registers saved by __x86_probe_read
+static coil_err_t __x86_probe_restore(void) {
+  coil_err_t err = COIL_ERR_GOOD;
+
+  if (cop_codegen_state.conf->probe_counter >= 0) err = __x86_emit_pop64(X86_RCX);
+  if (err == COIL_ERR_GOOD) err = __x86_emit_pop64(X86_RDX);
+  if (err == COIL_ERR_GOOD) err = __x86_emit_pop64(X86_RAX);
+  return err;
+}
+
+// Count the call and subtract the counter from the cycles of the function
+coil_err_t __x86_probe_enter(void) {
+  coil_byte_t inc[] = {X86_REX | X86_REX_W, 0xFF, 0x05}; // inc qword [rip + disp32]
+  coil_byte_t sub[] = {X86_REX | X86_REX_W, 0x29, 0x05}; // sub [rip + disp32], rax
+
+  coil_err_t err = __x86_probe_read();
+  if (err == COIL_ERR_GOOD) err = __x86_probe_update(inc, sizeof(inc), COP_PROFILE_CALLS);
+  if (err == COIL_ERR_GOOD) err = __x86_probe_update(sub, sizeof(sub), COP_PROFILE_CYCLES);
+  if (err == COIL_ERR_GOOD) err = __x86_probe_restore();
+  return err;
+}
+
+// Add the counter to the cycles of the function
+coil_err_t __x86_probe_leave(void) {
+  coil_byte_t add[] = {X86_REX | X86_REX_W, 0x01, 0x05}; // add [rip + disp32], rax
+
+  coil_err_t err = __x86_probe_read();
+  if (err == COIL_ERR_GOOD) err = __x86_probe_update(add, sizeof(add), COP_PROFILE_CYCLES);
+  if (err == COIL_ERR_GOOD) err = __x86_probe_restore();
+  return err;
+}
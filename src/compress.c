@@ -0,0 +1,207 @@
+#include <src/compress.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define COP_LZ_HASHLOG 12
+#define COP_LZ_LASTLITERALS 5   // the last bytes are always literals
+#define COP_LZ_MFLIMIT 12       // no match starts in the last bytes
+#define COP_LZ_MAXOFFSET 65535
+#define COP_LZ_SKIPTRIGGER 6    // search step grows every 2^n misses over incompressible data
+
+static coil_u32_t cop_lz_read32(const coil_byte_t *p) {
+  coil_u32_t v;
+  memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+static coil_u32_t cop_lz_hash(coil_u32_t v) {
+  return (v * 2654435761u) >> (32 - COP_LZ_HASHLOG);
+}
+
+static coil_byte_t *cop_lz_put_length(coil_byte_t *op, coil_size_t len) {
+  while (len >= 255) {
+    *op++ = 255;
+    len -= 255;
+  }
+  *op++ = (coil_byte_t)len;
+  return op;
+}
+
+static coil_byte_t *cop_lz_put_sequence(coil_byte_t *op, const coil_byte_t *lit, coil_size_t litlen, coil_size_t offset, coil_size_t matchlen) {
+  coil_byte_t *token = op++;
+  coil_size_t mcode = matchlen ? matchlen - COP_LZ_MINMATCH : 0;
+
+  *token = (coil_byte_t)(((litlen < 15 ? litlen : 15) << 4) | (mcode < 15 ? mcode : 15));
+  if (litlen >= 15) op = cop_lz_put_length(op, litlen - 15);
+
+  memcpy(op, lit, litlen);
+  op += litlen;
+
+  if (!matchlen) return op;
+
+  *op++ = (coil_byte_t)(offset & 0xFF);
+  *op++ = (coil_byte_t)(offset >> 8);
+  if (mcode >= 15) op = cop_lz_put_length(op, mcode - 15);
+  return op;
+}
+
+coil_size_t cop_lz_compress(const coil_byte_t *src, coil_size_t size, coil_byte_t *dst) {
+  coil_u32_t table[1 << COP_LZ_HASHLOG];
+  coil_byte_t *op = dst + COP_LZ_HEADER;
+  coil_size_t anchor = 0;
+  coil_size_t ip = 0;
+
+  dst[0] = (coil_byte_t)(size);
+  dst[1] = (coil_byte_t)(size >> 8);
+  dst[2] = (coil_byte_t)(size >> 16);
+  dst[3] = (coil_byte_t)(size >> 24);
+
+  if (size >= COP_LZ_MFLIMIT) {
+    coil_size_t limit = size - COP_LZ_MFLIMIT;
+    coil_size_t matchlimit = size - COP_LZ_LASTLITERALS;
+    coil_size_t misses = 0;
+
+    memset(table, 0, sizeof(table));
+
+    while (ip < limit) {
+      coil_u32_t seq = cop_lz_read32(src + ip);
+      coil_u32_t h = cop_lz_hash(seq);
+      coil_size_t ref = table[h];
+      table[h] = (coil_u32_t)ip;
+
+      if (ref >= ip || ip - ref > COP_LZ_MAXOFFSET || cop_lz_read32(src + ref) != seq) {
+        ip += 1 + (misses++ >> COP_LZ_SKIPTRIGGER);
+        continue;
+      }
+      misses = 0;
+
+      // extend backwards into the pending literals
+      while (ip > anchor && ref > 0 && src[ip - 1] == src[ref - 1]) {
+        ip--;
+        ref--;
+      }
+
+      coil_size_t len = COP_LZ_MINMATCH;
+      while (ip + len < matchlimit && src[ip + len] == src[ref + len]) len++;
+
+      op = cop_lz_put_sequence(op, src + anchor, ip - anchor, ip - ref, len);
+      ip += len;
+      anchor = ip;
+
+      // keep the table fresh for the bytes just skipped
+      if (ip - 2 < limit) table[cop_lz_hash(cop_lz_read32(src + ip - 2))] = (coil_u32_t)(ip - 2);
+    }
+  }
+
+  op = cop_lz_put_sequence(op, src + anchor, size - anchor, 0, 0);
+  return (coil_size_t)(op - dst);
+}
+
+coil_size_t cop_lz_size(const coil_byte_t *src, coil_size_t size) {
+  if (size < COP_LZ_HEADER) return 0;
+  return (coil_size_t)src[0] | ((coil_size_t)src[1] << 8) | ((coil_size_t)src[2] << 16) | ((coil_size_t)src[3] << 24);
+}
+
+// Read the extension bytes of a length nibble of 15
+static const coil_byte_t *cop_lz_get_length(const coil_byte_t *ip, const coil_byte_t *iend, coil_size_t *len) {
+  coil_byte_t b;
+  do {
+    if (ip >= iend) return NULL;
+    b = *ip++;
+    *len += b;
+  } while (b == 255);
+  return ip;
+}
+
+coil_err_t cop_lz_decompress(const coil_byte_t *src, coil_size_t size, coil_byte_t *dst) {
+  coil_size_t raw = cop_lz_size(src, size);
+  const coil_byte_t *ip = src + COP_LZ_HEADER;
+  const coil_byte_t *iend = src + size;
+  coil_byte_t *op = dst;
+  coil_byte_t *oend = dst + raw;
+
+  if (size < COP_LZ_HEADER) return COIL_ERR_FORMAT;
+
+  while (ip < iend) {
+    coil_byte_t token = *ip++;
+
+    coil_size_t litlen = token >> 4;
+    if (litlen == 15 && !(ip = cop_lz_get_length(ip, iend, &litlen))) return COIL_ERR_FORMAT;
+    if (litlen > (coil_size_t)(iend - ip) || litlen > (coil_size_t)(oend - op)) return COIL_ERR_FORMAT;
+
+    memcpy(op, ip, litlen);
+    ip += litlen;
+    op += litlen;
+
+    // the last sequence ends after its literals
+    if (ip == iend) break;
+
+    if (iend - ip < 2) return COIL_ERR_FORMAT;
+    coil_size_t offset = (coil_size_t)ip[0] | ((coil_size_t)ip[1] << 8);
+    ip += 2;
+    if (offset == 0 || offset > (coil_size_t)(op - dst)) return COIL_ERR_FORMAT;
+
+    coil_size_t matchlen = token & 15;
+    if (matchlen == 15 && !(ip = cop_lz_get_length(ip, iend, &matchlen))) return COIL_ERR_FORMAT;
+    matchlen += COP_LZ_MINMATCH;
+    if (matchlen > (coil_size_t)(oend - op)) return COIL_ERR_FORMAT;
+
+    const coil_byte_t *ref = op - offset;
+    if (offset >= matchlen) {
+      memcpy(op, ref, matchlen);
+      op += matchlen;
+    } else {
+      // overlapping match repeats the last offset bytes
+      while (matchlen--) *op++ = *ref++;
+    }
+  }
+
+  return op == oend ? COIL_ERR_GOOD : COIL_ERR_FORMAT;
+}
+
+// Replace the bytes of sect with size bytes of data
+// The section is rewritten rather than rebuilt so its relocations and other metadata are kept
+static coil_err_t cop_section_replace(coil_section_t *sect, const coil_byte_t *data, coil_size_t size) {
+  sect->rindex = 0;
+  sect->windex = 0;
+  sect->size = 0;
+  return coil_section_write(sect, (coil_byte_t *)data, size, NULL);
+}
+
+coil_err_t cop_section_compress(coil_section_header_t *header, coil_section_t *sect) {
+  if (header->flags & COP_SECTION_FLAG_COMPRESSED) return COIL_ERR_GOOD;
+  if (sect->size > UINT32_MAX) return COIL_ERR_NOTSUP;
+
+  coil_byte_t *packed = malloc(COP_LZ_BOUND(sect->size));
+  if (!packed) return COIL_ERR_NOMEM;
+
+  coil_size_t packed_size = cop_lz_compress(sect->data, sect->size, packed);
+
+  coil_err_t err = COIL_ERR_GOOD;
+  if (packed_size < sect->size) {
+    err = cop_section_replace(sect, packed, packed_size);
+    if (err == COIL_ERR_GOOD) header->flags |= COP_SECTION_FLAG_COMPRESSED;
+  }
+
+  free(packed);
+  return err;
+}
+
+cop_err_t cop_section_decompress(coil_section_header_t *header, coil_section_t *sect) {
+  if (!(header->flags & COP_SECTION_FLAG_COMPRESSED)) return COIL_ERR_GOOD;
+
+  coil_size_t raw = cop_lz_size(sect->data, sect->size);
+  coil_byte_t *data = malloc(raw ? raw : 1);
+  if (!data) return COIL_ERR_NOMEM;
+
+  coil_err_t err = cop_lz_decompress(sect->data, sect->size, data);
+  if (err != COIL_ERR_GOOD) {
+    coil_log(COIL_LEVEL_ERROR, "Corrupt compressed section");
+  } else {
+    err = cop_section_replace(sect, data, raw);
+    if (err == COIL_ERR_GOOD) header->flags &= ~COP_SECTION_FLAG_COMPRESSED;
+  }
+
+  free(data);
+  return err;
+}
@@ -0,0 +1,83 @@
+/**
+* @file src/compress.h
+* @brief Section compression for the COIL Object Processor (COP)
+*
+* A small LZ77 byte codec in the style of LZ4, chosen for decode speed over
+* ratio. Every section is compressed on its own so readers only inflate the
+* sections they need.
+*
+* A compressed section is stored as
+*   [raw size: u32 little endian][sequence]...
+* where a sequence is
+*   [token: u8][literal length...][literals][match offset: u16 little endian][match length...]
+* The high nibble of the token is the literal length and the low nibble the
+* match length minus COP_LZ_MINMATCH, a nibble of 15 is followed by bytes that
+* are added to it until one is below 255. The last sequence has no match.
+*
+* COP_SECTION_FLAG_COMPRESSED and cop_section_decompress are public, see cop.h.
+*/
+
+#ifndef __COP_INCLUDE_GUARD_COMPRESS_H
+#define __COP_INCLUDE_GUARD_COMPRESS_H
+
+#include <cop.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define COP_LZ_MINMATCH 4
+#define COP_LZ_HEADER 4
+
+/**
+* @brief Largest compressed size of size bytes, header included
+*/
+#define COP_LZ_BOUND(size) (COP_LZ_HEADER + (size) + (size) / 255 + 16)
+
+/**
+* @brief Compress a buffer
+*
+* @param src Uncompressed data
+* @param size Size of src, at most UINT32_MAX
+* @param dst Output buffer of at least COP_LZ_BOUND(size) bytes
+*
+* @return coil_size_t Compressed size, header included
+*/
+coil_size_t cop_lz_compress(const coil_byte_t *src, coil_size_t size, coil_byte_t *dst);
+
+/**
+* @brief Read the uncompressed size from a compressed buffer
+*
+* @return coil_size_t Uncompressed size, 0 if size is too small for a header
+*/
+coil_size_t cop_lz_size(const coil_byte_t *src, coil_size_t size);
+
+/**
+* @brief Decompress a buffer
+*
+* @param src Compressed data, header included
+* @param size Size of src
+* @param dst Output buffer of cop_lz_size(src, size) bytes
+*
+* @return coil_err_t COIL_ERR_GOOD on success
+* @return coil_err_t COIL_ERR_FORMAT if src is corrupt
+*/
+coil_err_t cop_lz_decompress(const coil_byte_t *src, coil_size_t size, coil_byte_t *dst);
+
+/**
+* @brief Compress a section in place
+*
+* Sections which do not shrink are left as they are without the flag.
+* Only the bytes are compressed, relocations stay on the section and keep
+* referring to offsets of the uncompressed bytes.
+*
+* @param header Section header, COP_SECTION_FLAG_COMPRESSED is set on success
+* @param sect Section to compress
+*/
+coil_err_t cop_section_compress(coil_section_header_t *header, coil_section_t *sect);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __COP_INCLUDE_GUARD_COMPRESS_H */
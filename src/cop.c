@@ -1,19 +1,464 @@
-#include <cop.h>
+// clock_gettime and CLOCK_MONOTONIC are POSIX, not C99
+#define _POSIX_C_SOURCE 199309L
+
+#include <src/codegen.h>
+#include <src/compress.h>
+#include <src/inline.h>
+#include <src/intern.h>
+#include <src/profile.h>
+#include <src/reach.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
 
 // Array of Generators
-// TODO...
+extern coil_err_t __cop_codegen_x86   (coil_object_t *obj, coil_section_header_t *header, coil_section_t *sect);
+extern coil_err_t __cop_codegen_x86_32(coil_object_t *obj, coil_section_header_t *header, coil_section_t *sect);
+extern coil_err_t __cop_codegen_x86_64(coil_object_t *obj, coil_section_header_t *header, coil_section_t *sect);
+
+static const cop_codegen_ft cop_generators[] = {
+  [COP_ARCH_X86]    = __cop_codegen_x86,
+  [COP_ARCH_X86_32] = __cop_codegen_x86_32,
+  [COP_ARCH_X86_64] = __cop_codegen_x86_64,
+};
+
+// Registers preserved across calls by the calling convention of each target
+static const coil_u32_t cop_preserved[] = {
+  [COP_ARCH_X86]    = (1u << 3) | (1u << 4) | (1u << 5) | (1u << 6) | (1u << 7),   // bx sp bp si di
+  [COP_ARCH_X86_32] = (1u << 3) | (1u << 4) | (1u << 5) | (1u << 6) | (1u << 7),   // ebx esp ebp esi edi
+  [COP_ARCH_X86_64] = (1u << 3) | (1u << 4) | (1u << 5) | (0xFu << 12),            // rbx rsp rbp r12-r15
+};
+
+cop_codegen_state_t cop_codegen_state;
+
+void cop_config_default(cop_config_t *conf) {
+  memset(conf, 0, sizeof(*conf));
+  conf->arch = COP_ARCH_X86_64;
+  conf->function_align = 16;
+  conf->loop_align = 16;
+  conf->align_max_skip = 0;
+  conf->align_budget = 0;
+  conf->compress = 0;
+  conf->inline_threshold = 0;
+  conf->roots = NULL;
+  conf->root_count = 0;
+  conf->instrument = 0;
+  conf->probes = NULL;
+  conf->probe_count = 0;
+  conf->probe_counter = -1;
+}
+
+static coil_u64_t cop_time_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (coil_u64_t)ts.tv_sec * 1000000000u + (coil_u64_t)ts.tv_nsec;
+}
+
+static double cop_mbps(coil_size_t bytes, coil_u64_t ns) {
+  return ns ? ((double)bytes / (1024.0 * 1024.0)) / ((double)ns / 1e9) : 0.0;
+}
+
+void cop_stats_print(FILE *stream, const cop_stats_t *stats) {
+  fprintf(stream, "sections lowered:     %zu, %zu unreachable kept as IR only\n", (size_t)stats->sections, (size_t)stats->unreachable);
+  fprintf(stream, "symbols:              %zu, %zu repeated names shared\n", (size_t)stats->symbols, (size_t)stats->strings_deduped);
+  fprintf(stream, "native bytes:         %zu\n", (size_t)stats->native_bytes);
+  fprintf(stream, "functions:            %zu leaf, %zu frameless, %zu callee saved registers pushed\n",
+    (size_t)stats->leaf_functions, (size_t)stats->frameless, (size_t)stats->saved_regs);
+  fprintf(stream, "inlined call sites:   %zu, IR %zu -> %zu bytes (%+lld), %zu tail calls\n", (size_t)stats->inline_sites,
+    (size_t)stats->inline_ir_before, (size_t)stats->inline_ir_after,
+    (long long)stats->inline_ir_after - (long long)stats->inline_ir_before, (size_t)stats->tail_calls);
+  if (stats->probed) fprintf(stream, "probed functions:     %zu\n", (size_t)stats->probed);
+  fprintf(stream, "alignment points:     %zu padded, %zu skipped\n", (size_t)stats->align_points, (size_t)stats->align_skipped);
+  fprintf(stream, "alignment padding:    %zu bytes (%.2f%% of native)\n", (size_t)stats->align_bytes,
+    stats->native_bytes ? 100.0 * (double)stats->align_bytes / (double)stats->native_bytes : 0.0);
+  if (stats->packed_in) {
+    fprintf(stream, "compressed sections:  %zu, %zu -> %zu bytes (ratio %.2f)\n", (size_t)stats->packed_count,
+      (size_t)stats->packed_in, (size_t)stats->packed_out, stats->packed_out ? (double)stats->packed_in / (double)stats->packed_out : 0.0);
+    fprintf(stream, "compression speed:    %.1f MB/s compress, %.1f MB/s decompress\n",
+      cop_mbps(stats->packed_in, stats->compress_ns), cop_mbps(stats->inflated, stats->inflate_ns));
+  }
+}
+
+// Compress a native section, inflating it again to verify it when measuring
+static coil_err_t cop_process_compress(coil_section_header_t *header, coil_section_t *native) {
+  cop_stats_t *stats = cop_codegen_state.stats;
+  coil_size_t size = native->size;
+  coil_u64_t start = cop_time_ns();
+
+  coil_err_t err = cop_section_compress(header, native);
+  if (err != COIL_ERR_GOOD) return err;
+
+  stats->compress_ns += cop_time_ns() - start;
+  stats->packed_in += size;
+  stats->packed_out += native->size;
+
+  if (!(header->flags & COP_SECTION_FLAG_COMPRESSED)) return COIL_ERR_GOOD;
+  stats->packed_count++;
+
+  if (cop_codegen_state.measure) {
+    coil_byte_t *raw = malloc(size ? size : 1);
+    if (!raw) return COIL_ERR_NOMEM;
+
+    start = cop_time_ns();
+    err = cop_lz_decompress(native->data, native->size, raw);
+    stats->inflate_ns += cop_time_ns() - start;
+    stats->inflated += size;
+
+    free(raw);
+    if (err != COIL_ERR_GOOD) {
+      coil_log(COIL_LEVEL_ERROR, "Compressed section failed to inflate");
+      return err;
+    }
+  }
+
+  return COIL_ERR_GOOD;
+}
+
+// Function entries are the section starts, they are aligned by the linker placing the section
+// The padding it may insert is counted at its worst case and held to the max skip and budget like padding inside
+static void cop_process_entry_align(coil_section_header_t *header) {
+  const cop_config_t *conf = cop_codegen_state.conf;
+  cop_stats_t *stats = cop_codegen_state.stats;
+  coil_u32_t align = conf->function_align;
+  coil_u32_t have = header->align ? header->align : 1;
+
+  if (align <= have) return;
+
+  coil_size_t worst = align - have;
+  coil_size_t max_skip = conf->align_max_skip ? conf->align_max_skip : align - 1;
+  if (worst > max_skip || (conf->align_budget && worst > conf->align_budget)) {
+    stats->align_skipped++;
+    return;
+  }
+
+  header->align = align;
+  cop_codegen_state.align_used = worst;
+  stats->align_points++;
+  stats->align_bytes += worst;
+}
+
+// Lower COIL section index of src into a new native section of dest
+// Calls are inlined first when inl is not NULL, the inlined IR is only used to generate code from
+static coil_err_t cop_process_section(coil_object_t *dest, coil_object_t *src, cop_codegen_ft gen, cop_inline_t *inl, coil_u16_t index) {
+  const cop_config_t *conf = cop_codegen_state.conf;
+  cop_stats_t *stats = cop_codegen_state.stats;
+  coil_section_header_t *header = &src->sectheaders[index];
+  coil_section_t *sect = &src->sections[index];
+  coil_section_header_t native_header = dest->sectheaders[index];  // names are already moved into dest
+  coil_section_t inlined;
+  coil_size_t sites = 0;
+  coil_section_t native;
+  coil_err_t err;
+
+  if (inl) {
+    err = cop_inline_section(inl, index, &inlined, &sites);
+    if (err != COIL_ERR_GOOD) return err;
+  }
+  if (sites) {
+    stats->inline_sites += sites;
+    stats->inline_ir_before += sect->size;
+    stats->inline_ir_after += inlined.size;
+    sect = &inlined;
+  }
+
+  err = coil_section_init(&native, sect->size);
+  if (err != COIL_ERR_GOOD) goto done;
+
+  native_header.flags |= COIL_SECTION_FLAG_NATIVE;
+  cop_codegen_state.align_used = 0;
+  cop_process_entry_align(&native_header);
+
+  // Padding is relative to the section start, so it aligns no further than the section itself
+  cop_codegen_state.native = &native;
+  cop_codegen_state.section_align = native_header.align ? native_header.align : 1;
+
+  err = gen(src, header, sect);
+  if (err == COIL_ERR_GOOD && conf->compress) err = cop_process_compress(&native_header, &native);
+  if (err == COIL_ERR_GOOD) err = coil_object_add_section(dest, &native_header, &native);
+
+  cop_codegen_state.native = NULL;
+  if (err != COIL_ERR_GOOD) coil_section_cleanup(&native);
+  else stats->sections++;
+
+done:
+  if (sites) coil_section_cleanup(&inlined);
+  return err;
+}
+
+// Move the src string at *name into dest, writing each distinct string once
+// Sets str and len to the string read from src
+static coil_err_t cop_process_string(coil_object_t *dest, coil_object_t *src, cop_intern_t *strings, coil_u64_t *name, const char **str, coil_size_t *len) {
+  int added;
+
+  *str = coil_object_get_string(src, *name, len);
+  if (!*str) {
+    coil_log(COIL_LEVEL_ERROR, "Name at string offset %llu is not in the string table", (unsigned long long)*name);
+    return coil_error_get_last();
+  }
+
+  coil_u64_t *offset = cop_intern_put(strings, *str, *len, &added);
+  if (!offset) return COIL_ERR_NOMEM;
+
+  if (added) {
+    coil_err_t err = coil_object_add_string(dest, *str, *len, offset);
+    if (err != COIL_ERR_GOOD) return err;
+  } else {
+    cop_codegen_state.stats->strings_deduped++;
+  }
+
+  *name = *offset;
+  return COIL_ERR_GOOD;
+}
+
+// Copy the sections and symbols of src into dest
+// The sections keep their indices so symbols stay valid, native sections are appended after them
+// Section and symbol names are the only string table references in a COIL object, so the string table of dest
+// is rebuilt from them with every distinct name written once, strings nothing refers to are not carried over
+// Symbols are appended in order, source symbol i is destination symbol symbol_base + i
+// Fills symbols, when not NULL, with the destination index of every symbol name for lookups by name,
+// a repeated name resolves to its first symbol
+static coil_err_t cop_process_load(coil_object_t *dest, coil_object_t *src, cop_intern_t *symbols) {
+  cop_intern_t strings;
+  coil_err_t err;
+  int added;
+
+  err = cop_intern_init(&strings, src->symbol_count + src->section_count);
+  if (err != COIL_ERR_GOOD) return err;
+
+  for (coil_u16_t i = 0; i < src->section_count; ++i) {
+    coil_section_header_t header = src->sectheaders[i];
+    const char *name;
+    coil_size_t len;
+
+    err = cop_process_string(dest, src, &strings, &header.name, &name, &len);
+    if (err != COIL_ERR_GOOD) goto done;
+
+    err = coil_object_add_section(dest, &header, &src->sections[i]);
+    if (err != COIL_ERR_GOOD) goto done;
+  }
+
+  cop_codegen_state.symbol_base = dest->symbol_count;
+  for (coil_u32_t i = 0; i < src->symbol_count; ++i) {
+    coil_symbol_t sym = src->symbols[i];
+    const char *name;
+    coil_size_t len;
 
-cop_err_t cop_process(coil_object_t *dest, coil_object_t *src) {
-  // Filter based on the Processing unit for generator function array
+    err = cop_process_string(dest, src, &strings, &sym.name, &name, &len);
+    if (err != COIL_ERR_GOOD) goto done;
+
+    coil_u64_t index;
+    err = coil_object_add_symbol(dest, &sym, &index);
+    if (err != COIL_ERR_GOOD) goto done;
+
+    if (!symbols) continue;
+
+    coil_u64_t *value = cop_intern_put(symbols, name, len, &added);
+    if (!value) {
+      err = COIL_ERR_NOMEM;
+      goto done;
+    }
+    if (added) *value = index;
+  }
+
+  cop_codegen_state.stats->symbols += src->symbol_count;
+
+done:
+  cop_intern_cleanup(&strings);
+  return err;
+}
+
+// Find the sections defining the symbols named by names
+// what names the symbols in error messages
+static coil_err_t cop_process_resolve(coil_object_t *dest, const cop_intern_t *symbols, const char *const *names, coil_size_t count, const char *what, coil_u16_t *sections) {
+  for (coil_size_t i = 0; i < count; ++i) {
+    coil_u64_t index;
+
+    if (!cop_intern_find(symbols, names[i], strlen(names[i]), &index)) {
+      coil_log(COIL_LEVEL_ERROR, "%s symbol '%s' not found", what, names[i]);
+      return COIL_ERR_NOTFOUND;
+    }
+    sections[i] = dest->symbols[index].section;
+  }
+
+  return COIL_ERR_GOOD;
+}
+
+// Mark the sections reachable from the root symbols of conf
+static coil_err_t cop_process_reach(coil_object_t *dest, coil_object_t *src, const cop_intern_t *symbols, coil_u8_t *reachable) {
+  const cop_config_t *conf = cop_codegen_state.conf;
+
+  coil_u16_t *roots = malloc(conf->root_count * sizeof(coil_u16_t));
+  if (!roots) return COIL_ERR_NOMEM;
+
+  coil_err_t err = cop_process_resolve(dest, symbols, conf->roots, conf->root_count, "Root", roots);
+  if (err == COIL_ERR_GOOD) err = cop_reach_mark(src, roots, conf->root_count, reachable);
+  free(roots);
+  return err;
+}
+
+// Mark the sections of the probe symbols of conf
+static coil_err_t cop_process_probes(coil_object_t *dest, coil_object_t *src, const cop_intern_t *symbols, coil_u8_t *probed) {
+  const cop_config_t *conf = cop_codegen_state.conf;
+
+  coil_u16_t *probes = malloc(conf->probe_count * sizeof(coil_u16_t));
+  if (!probes) return COIL_ERR_NOMEM;
+
+  coil_err_t err = cop_process_resolve(dest, symbols, conf->probes, conf->probe_count, "Probe", probes);
+  if (err == COIL_ERR_GOOD) {
+    memset(probed, 0, src->section_count);
+    for (coil_size_t i = 0; i < conf->probe_count; ++i) {
+      if (probes[i] < src->section_count) probed[probes[i]] = 1;
+    }
+  }
+  free(probes);
+  return err;
+}
+
+// Add the symbol at the start of the counter section, its section is set once the section is added
+static coil_err_t cop_process_profile_symbol(coil_object_t *dest, const char *name, coil_u64_t value, coil_u64_t *index) {
+  coil_symbol_t sym = {0};
+
+  coil_err_t err = coil_object_add_string(dest, name, strlen(name), &sym.name);
+  if (err != COIL_ERR_GOOD) return err;
+
+  sym.value = value;
+  return coil_object_add_symbol(dest, &sym, index);
+}
+
+// Add the counter section after the native sections and point the profile symbols at it
+static coil_err_t cop_process_profile(coil_object_t *dest, coil_section_t *prof) {
+  coil_section_header_t header = {0};
+  coil_u16_t section = dest->section_count;
+  coil_u64_t end;
+
+  coil_err_t err = coil_object_add_string(dest, COP_PROFILE_SECTION, sizeof(COP_PROFILE_SECTION) - 1, &header.name);
+  if (err != COIL_ERR_GOOD) return err;
+  // counters are data the probes write, never code
+  header.flags = COIL_SECTION_FLAG_ALLOC | COIL_SECTION_FLAG_WRITE;
+  header.align = 8;
+
+  err = cop_process_profile_symbol(dest, COP_PROFILE_SYMBOL_END, prof->size, &end);
+  if (err != COIL_ERR_GOOD) return err;
+
+  err = coil_object_add_section(dest, &header, prof);
+  if (err != COIL_ERR_GOOD) return err;
+
+  dest->symbols[cop_codegen_state.probe_symbol].section = section;
+  dest->symbols[end].section = section;
+  return COIL_ERR_GOOD;
+}
+
+cop_err_t cop_process(coil_object_t *dest, coil_object_t *src, const cop_config_t *conf, cop_stats_t *stats) {
+  cop_inline_t inl = {0};
+  coil_u8_t *reachable = NULL;
+  coil_u8_t *probed = NULL;
+  coil_section_t prof = {0};
+  cop_intern_t symbols = {0};
+  cop_stats_t discard;
+  coil_err_t err;
 
   // Filter based on the architecture for generator function
+  if ((size_t)conf->arch >= sizeof(cop_generators) / sizeof(cop_generators[0])) {
+    coil_log(COIL_LEVEL_ERROR, "Unsupported architecture: %d", conf->arch);
+    return COIL_ERR_NOTSUP;
+  }
+  cop_codegen_ft gen = cop_generators[conf->arch];
+
+  // probes rely on the System V frames of the x86-64 generator
+  if (conf->instrument && conf->arch != COP_ARCH_X86_64) {
+    coil_log(COIL_LEVEL_ERROR, "Instrumentation is only supported for x86-64");
+    return COIL_ERR_NOTSUP;
+  }
+
+  if (!stats) {
+    memset(&discard, 0, sizeof(discard));
+    stats = &discard;
+  }
+  cop_codegen_state.conf = conf;
+  cop_codegen_state.stats = stats;
+  cop_codegen_state.measure = stats != &discard;
+
+  // Load sections, symbols and strings into the destination object
+  // symbols are only looked up by name for roots and probes
+  int by_name = conf->root_count || (conf->instrument && conf->probe_count);
+  if (by_name) {
+    err = cop_intern_init(&symbols, src->symbol_count);
+    if (err != COIL_ERR_GOOD) return err;
+  }
+
+  err = cop_process_load(dest, src, by_name ? &symbols : NULL);
+  if (err != COIL_ERR_GOOD) goto done;
+
+  // without roots every section is lowered
+  if (conf->root_count) {
+    reachable = malloc(src->section_count ? src->section_count : 1);
+    if (!reachable) {
+      err = COIL_ERR_NOMEM;
+      goto done;
+    }
+
+    err = cop_process_reach(dest, src, &symbols, reachable);
+    if (err != COIL_ERR_GOOD) goto done;
+  }
+
+  // without probe symbols every function is probed
+  if (conf->instrument) {
+    if (conf->probe_count) {
+      probed = malloc(src->section_count ? src->section_count : 1);
+      if (!probed) {
+        err = COIL_ERR_NOMEM;
+        goto done;
+      }
+
+      err = cop_process_probes(dest, src, &symbols, probed);
+      if (err != COIL_ERR_GOOD) goto done;
+    }
+
+    err = coil_section_init(&prof, COP_PROFILE_RECORD * 16);
+    if (err != COIL_ERR_GOOD) goto done;
+
+    err = cop_process_profile_symbol(dest, COP_PROFILE_SYMBOL, 0, &cop_codegen_state.probe_symbol);
+    if (err != COIL_ERR_GOOD) goto done;
+  }
+
+  if (conf->inline_threshold) {
+    err = cop_inline_init(&inl, src, conf->inline_threshold, cop_preserved[conf->arch]);
+    if (err != COIL_ERR_GOOD) goto done;
+  }
 
-  // Setup destination object
-  
   // filter through each section
+  for (coil_u16_t i = 0; i < src->section_count; ++i) {
     // if COIL section call generator function for target
-    // else move into destination
-  // END filter
+    if (!(src->sectheaders[i].flags & COIL_SECTION_FLAG_CODE)) continue;
 
-  return COIL_ERR_GOOD;
-}
\ No newline at end of file
+    // unreachable sections are left for the linker to lower if it needs them
+    if (reachable && !reachable[i]) {
+      stats->unreachable++;
+      continue;
+    }
+
+    cop_codegen_state.probe = conf->instrument && (!probed || probed[i]);
+    if (cop_codegen_state.probe) {
+      err = cop_profile_add(&prof, dest->sectheaders[i].name, &cop_codegen_state.probe_record);
+      if (err != COIL_ERR_GOOD) goto done;
+      stats->probed++;
+    }
+
+    err = cop_process_section(dest, src, gen, inl.callees ? &inl : NULL, i);
+    if (err != COIL_ERR_GOOD) goto done;
+  }
+
+  if (conf->instrument) {
+    err = cop_process_profile(dest, &prof);
+    if (err == COIL_ERR_GOOD) prof.data = NULL; // owned by dest now
+  }
+
+done:
+  cop_codegen_state.probe = 0;
+  cop_inline_cleanup(&inl);
+  cop_intern_cleanup(&symbols);
+  if (prof.data) coil_section_cleanup(&prof);
+  free(reachable);
+  free(probed);
+  return err;
+}
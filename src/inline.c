@@ -0,0 +1,410 @@
+#include <src/inline.h>
+#include <src/ir.h>
+#include <stdlib.h>
+#include <string.h>
+
+// An in-section offset operand of the copy, patched once every instruction has moved
+typedef struct cop_inline_ref_s {
+  coil_size_t end;        // offset of the end of the value in the copy
+  coil_size_t size;       // bytes of the value
+  coil_u64_t target;      // offset of the target in the original
+} cop_inline_ref_t;
+
+// Where the instructions of the original ended up in the copy, in increasing order
+typedef struct cop_inline_map_s {
+  coil_size_t from;
+  coil_size_t to;
+} cop_inline_map_t;
+
+typedef struct cop_inline_copy_s {
+  coil_section_t *src;
+  coil_section_t *out;
+  cop_inline_map_t *map;
+  coil_size_t map_count, map_cap;
+  cop_inline_ref_t *refs;
+  coil_size_t ref_count, ref_cap;
+} cop_inline_copy_t;
+
+// sparam instructions waiting for the call they belong to
+typedef struct cop_inline_pending_s {
+  coil_u8_t count;
+  coil_size_t offsets[COP_INLINE_PARAMS_MAX];
+  cop_inline_range_t values[COP_INLINE_PARAMS_MAX];
+  coil_u8_t is_reg[COP_INLINE_PARAMS_MAX];
+  coil_u8_t regs[COP_INLINE_PARAMS_MAX];
+} cop_inline_pending_t;
+
+coil_err_t cop_inline_init(cop_inline_t *inl, coil_object_t *obj, coil_u32_t threshold, coil_u32_t preserved) {
+  inl->obj = obj;
+  inl->threshold = threshold;
+  inl->preserved = preserved;
+  inl->callees = calloc(obj->section_count ? obj->section_count : 1, sizeof(cop_inline_callee_t));
+  return inl->callees ? COIL_ERR_GOOD : COIL_ERR_NOMEM;
+}
+
+void cop_inline_cleanup(cop_inline_t *inl) {
+  free(inl->callees);
+  inl->callees = NULL;
+}
+
+static void cop_inline_analyse(cop_inline_t *inl, coil_u16_t index, cop_inline_callee_t *c) {
+  coil_section_t *sect = &inl->obj->sections[index];
+  coil_size_t sret_at = 0, ret_at = 0;
+  coil_size_t cost = 0;
+  coil_size_t pos = 0;
+  int entry = 1, seen_sret = 0, seen_ret = 0;
+  cop_ir_instr_t instr;
+
+  c->state = COP_INLINE_NO;
+  if (!(inl->obj->sectheaders[index].flags & COIL_SECTION_FLAG_CODE)) return;
+
+  while (pos < sect->size) {
+    pos = cop_ir_decode(sect, pos, &instr);
+    if (!pos || seen_ret) return;
+
+    switch (instr.opcode) {
+      case COIL_OP_CALL: case COIL_OP_BR: case COIL_OP_JMP: case COIL_OP_SPARAM: case COIL_OP_GRET:
+        return;
+      case COIL_OP_GPARAM:
+        if (!entry) return;
+        break;
+      case COIL_OP_SRET:
+        if (seen_sret) return;
+        seen_sret = 1;
+        sret_at = instr.offset;
+        break;
+      case COIL_OP_RET:
+        seen_ret = 1;
+        ret_at = instr.offset;
+        break;
+      default:
+        // the sret must come right before the ret
+        if (seen_sret) return;
+        cost++;
+        break;
+    }
+
+    if (instr.opcode != COIL_OP_GPARAM && entry) {
+      entry = 0;
+      c->body.start = instr.offset;
+    }
+
+    // check every operand, offsets would need moving and preserved registers must not be written
+    coil_size_t oppos = instr.operands;
+    for (coil_u8_t i = 0; i < instr.operand_count; ++i) {
+      coil_operand_header_t op_header;
+      coil_u64_t value;
+      coil_size_t start = oppos;
+
+      oppos = cop_ir_operand(sect, oppos, &op_header, &value, NULL);
+      if (!oppos || op_header.type == COIL_TYPEOP_OFF) return;
+      if (i != 0) continue;
+
+      if (cop_ir_writes(instr.opcode) && op_header.type == COIL_TYPEOP_REG && ((inl->preserved >> (value & 31)) & 1)) return;
+
+      if (instr.opcode == COIL_OP_GPARAM) {
+        if (op_header.type != COIL_TYPEOP_REG || c->param_count == COP_INLINE_PARAMS_MAX) return;
+        c->param_regs[c->param_count] = (coil_u8_t)value;
+        c->params[c->param_count].start = start;
+        c->params[c->param_count].end = oppos;
+        c->param_count++;
+      } else if (instr.opcode == COIL_OP_SRET) {
+        c->ret.start = start;
+        c->ret.end = oppos;
+      }
+    }
+  }
+
+  if (!seen_ret || cost > inl->threshold) return;
+
+  c->body.end = seen_sret ? sret_at : ret_at;
+  c->state = COP_INLINE_YES;
+}
+
+// The callee of a call instruction if it can be inlined into section index
+static cop_inline_callee_t *cop_inline_callee(cop_inline_t *inl, coil_u16_t index, coil_section_t *sect, const cop_ir_instr_t *call, coil_u16_t *callee_index) {
+  coil_operand_header_t op_header;
+  coil_u64_t value;
+
+  if (call->operand_count != 1) return NULL;
+  if (!cop_ir_operand(sect, call->operands, &op_header, &value, NULL)) return NULL;
+  if (op_header.type != COIL_TYPEOP_SYM || value >= inl->obj->symbol_count) return NULL;
+
+  // only calls to the start of another section
+  const coil_symbol_t *sym = &inl->obj->symbols[value];
+  if (sym->section >= inl->obj->section_count || sym->section == index || sym->value != 0) return NULL;
+
+  cop_inline_callee_t *c = &inl->callees[sym->section];
+  if (c->state == COP_INLINE_UNKNOWN) cop_inline_analyse(inl, sym->section, c);
+  if (c->state != COP_INLINE_YES) return NULL;
+
+  *callee_index = sym->section;
+  return c;
+}
+
+static coil_err_t cop_inline_write(cop_inline_copy_t *cp, coil_section_t *from, coil_size_t start, coil_size_t end) {
+  return coil_section_write(cp->out, from->data + start, end - start, NULL);
+}
+
+static coil_err_t cop_inline_map(cop_inline_copy_t *cp, coil_size_t from) {
+  if (cp->map_count == cp->map_cap) {
+    coil_size_t cap = cp->map_cap ? cp->map_cap * 2 : 64;
+    cop_inline_map_t *map = realloc(cp->map, cap * sizeof(cop_inline_map_t));
+    if (!map) return COIL_ERR_NOMEM;
+    cp->map = map;
+    cp->map_cap = cap;
+  }
+
+  cp->map[cp->map_count].from = from;
+  cp->map[cp->map_count].to = cp->out->windex;
+  cp->map_count++;
+  return COIL_ERR_GOOD;
+}
+
+// Remember an offset operand of the copy ending at end
+static coil_err_t cop_inline_ref(cop_inline_copy_t *cp, coil_size_t end, coil_size_t size, coil_u64_t target) {
+  if (cp->ref_count == cp->ref_cap) {
+    coil_size_t cap = cp->ref_cap ? cp->ref_cap * 2 : 16;
+    cop_inline_ref_t *refs = realloc(cp->refs, cap * sizeof(cop_inline_ref_t));
+    if (!refs) return COIL_ERR_NOMEM;
+    cp->refs = refs;
+    cp->ref_cap = cap;
+  }
+
+  cp->refs[cp->ref_count].end = end;
+  cp->refs[cp->ref_count].size = size;
+  cp->refs[cp->ref_count].target = target;
+  cp->ref_count++;
+  return COIL_ERR_GOOD;
+}
+
+// Copy a caller instruction as it is, remembering its offset operands
+static coil_err_t cop_inline_copy_instr(cop_inline_copy_t *cp, const cop_ir_instr_t *instr) {
+  coil_size_t base = cp->out->windex;
+  coil_size_t pos = instr->operands;
+  coil_err_t err;
+
+  err = cop_inline_map(cp, instr->offset);
+  if (err != COIL_ERR_GOOD) return err;
+
+  for (coil_u8_t i = 0; i < instr->operand_count; ++i) {
+    coil_operand_header_t op_header;
+    coil_u64_t value;
+    coil_size_t valsize;
+
+    pos = cop_ir_operand(cp->src, pos, &op_header, &value, &valsize);
+    if (!pos) return coil_error_get_last();
+    if (op_header.type != COIL_TYPEOP_OFF) continue;
+
+    err = cop_inline_ref(cp, base + (pos - instr->offset), valsize, value);
+    if (err != COIL_ERR_GOOD) return err;
+  }
+
+  return cop_inline_write(cp, cp->src, instr->offset, instr->next);
+}
+
+static coil_err_t cop_inline_flush(cop_inline_copy_t *cp, cop_inline_pending_t *pending) {
+  for (coil_u8_t i = 0; i < pending->count; ++i) {
+    cop_ir_instr_t instr;
+    if (!cop_ir_decode(cp->src, pending->offsets[i], &instr)) return coil_error_get_last();
+
+    coil_err_t err = cop_inline_copy_instr(cp, &instr);
+    if (err != COIL_ERR_GOOD) return err;
+  }
+
+  pending->count = 0;
+  return COIL_ERR_GOOD;
+}
+
+// Copy one operand, an offset operand of the caller is remembered like those of copied instructions
+// Callee operands are never offsets, cop_inline_analyse rejects them
+static coil_err_t cop_inline_operand(cop_inline_copy_t *cp, coil_section_t *from, cop_inline_range_t range) {
+  coil_size_t base = cp->out->windex;
+  coil_err_t err;
+
+  if (from == cp->src) {
+    coil_operand_header_t op_header;
+    coil_u64_t value;
+    coil_size_t valsize;
+
+    if (!cop_ir_operand(from, range.start, &op_header, &value, &valsize)) return coil_error_get_last();
+    if (op_header.type == COIL_TYPEOP_OFF) {
+      err = cop_inline_ref(cp, base + (range.end - range.start), valsize, value);
+      if (err != COIL_ERR_GOOD) return err;
+    }
+  }
+
+  return cop_inline_write(cp, from, range.start, range.end);
+}
+
+// mov dst, value with the operands copied from their sections
+static coil_err_t cop_inline_mov(cop_inline_copy_t *cp, coil_section_t *dst_sect, cop_inline_range_t dst, coil_section_t *val_sect, cop_inline_range_t val) {
+  coil_byte_t op[2] = {COIL_OP_MOV, 2};
+  coil_err_t err;
+
+  err = coil_section_write(cp->out, op, sizeof(op), NULL);
+  if (err == COIL_ERR_GOOD) err = cop_inline_operand(cp, dst_sect, dst);
+  if (err == COIL_ERR_GOOD) err = cop_inline_operand(cp, val_sect, val);
+  return err;
+}
+
+// Each mov of the parameters is done in order so none may overwrite a value still to be read
+static int cop_inline_params_safe(const cop_inline_callee_t *c, const cop_inline_pending_t *pending) {
+  if (pending->count < c->param_count) return 0;
+
+  for (coil_u8_t j = 0; j < c->param_count; ++j) {
+    for (coil_u8_t k = j + 1; k < c->param_count; ++k) {
+      if (pending->is_reg[k] && pending->regs[k] == c->param_regs[j]) return 0;
+    }
+  }
+  return 1;
+}
+
+// Point the offset operands of the copy at where their targets moved
+static int cop_inline_patch(cop_inline_copy_t *cp) {
+  for (coil_size_t r = 0; r < cp->ref_count; ++r) {
+    const cop_inline_ref_t *ref = &cp->refs[r];
+    coil_size_t lo = 0, hi = cp->map_count;
+
+    while (lo < hi) {
+      coil_size_t mid = lo + (hi - lo) / 2;
+      if (cp->map[mid].from < ref->target) lo = mid + 1;
+      else hi = mid;
+    }
+    if (lo == cp->map_count || cp->map[lo].from != ref->target) return 0;
+
+    coil_u64_t to = cp->map[lo].to;
+    if (ref->size < 8 && (to >> (ref->size * 8))) return 0;
+
+    coil_byte_t *value = cp->out->data + ref->end - ref->size;
+    for (coil_size_t i = 0; i < ref->size; ++i) value[i] = (coil_byte_t)(i < 8 ? to >> (i * 8) : 0);
+  }
+  return 1;
+}
+
+// Check if any call of the section can be inlined before building a copy
+static int cop_inline_any(cop_inline_t *inl, coil_u16_t index, coil_section_t *sect) {
+  coil_size_t pos = 0;
+  cop_ir_instr_t instr;
+  coil_u16_t callee_index;
+
+  while (pos < sect->size) {
+    pos = cop_ir_decode(sect, pos, &instr);
+    if (!pos) return 0;
+    if (instr.opcode == COIL_OP_CALL && cop_inline_callee(inl, index, sect, &instr, &callee_index)) return 1;
+  }
+  return 0;
+}
+
+coil_err_t cop_inline_section(cop_inline_t *inl, coil_u16_t index, coil_section_t *out, coil_size_t *inlined) {
+  coil_section_t *sect = &inl->obj->sections[index];
+  cop_inline_copy_t cp = {sect, out};
+  cop_inline_pending_t pending;
+  cop_ir_instr_t instr;
+  coil_size_t pos = 0;
+  coil_size_t count = 0;
+  coil_err_t err;
+
+  *inlined = 0;
+  if (!inl->threshold || !cop_inline_any(inl, index, sect)) return COIL_ERR_GOOD;
+
+  err = coil_section_init(out, sect->size * 2);
+  if (err != COIL_ERR_GOOD) return err;
+
+  pending.count = 0;
+  while (pos < sect->size) {
+    pos = cop_ir_decode(sect, pos, &instr);
+    if (!pos) {
+      err = coil_error_get_last();
+      goto fail;
+    }
+
+    if (instr.opcode == COIL_OP_SPARAM) {
+      if (pending.count == COP_INLINE_PARAMS_MAX) {
+        err = cop_inline_flush(&cp, &pending);
+        if (err != COIL_ERR_GOOD) goto fail;
+      }
+
+      coil_operand_header_t op_header;
+      coil_u64_t value;
+      coil_size_t end = instr.operand_count ? cop_ir_operand(sect, instr.operands, &op_header, &value, NULL) : 0;
+      if (!end) {
+        err = instr.operand_count ? coil_error_get_last() : COIL_ERR_FORMAT;
+        goto fail;
+      }
+
+      pending.offsets[pending.count] = instr.offset;
+      pending.values[pending.count].start = instr.operands;
+      pending.values[pending.count].end = end;
+      pending.is_reg[pending.count] = op_header.type == COIL_TYPEOP_REG;
+      pending.regs[pending.count] = (coil_u8_t)value;
+      pending.count++;
+      continue;
+    }
+
+    coil_u16_t callee_index;
+    cop_inline_callee_t *c = NULL;
+    cop_ir_instr_t gret = {0};
+    if (instr.opcode == COIL_OP_CALL) c = cop_inline_callee(inl, index, sect, &instr, &callee_index);
+
+    // the return value is moved straight into the gret destination
+    if (c && instr.next < sect->size) {
+      if (!cop_ir_decode(sect, instr.next, &gret)) gret.opcode = COIL_OP_NOP;
+      if (gret.opcode == COIL_OP_GRET && (c->ret.start == c->ret.end || gret.operand_count != 1)) c = NULL;
+    }
+    if (c && !cop_inline_params_safe(c, &pending)) c = NULL;
+
+    if (!c) {
+      err = cop_inline_flush(&cp, &pending);
+      if (err == COIL_ERR_GOOD) err = cop_inline_copy_instr(&cp, &instr);
+      if (err != COIL_ERR_GOOD) goto fail;
+      continue;
+    }
+
+    coil_section_t *callee = &inl->obj->sections[callee_index];
+
+    for (coil_u8_t i = 0; i < pending.count; ++i) {
+      err = cop_inline_map(&cp, pending.offsets[i]);
+      if (err != COIL_ERR_GOOD) goto fail;
+    }
+    err = cop_inline_map(&cp, instr.offset);
+    if (err != COIL_ERR_GOOD) goto fail;
+
+    for (coil_u8_t i = 0; i < c->param_count; ++i) {
+      err = cop_inline_mov(&cp, callee, c->params[i], sect, pending.values[i]);
+      if (err != COIL_ERR_GOOD) goto fail;
+    }
+    pending.count = 0;
+
+    err = cop_inline_write(&cp, callee, c->body.start, c->body.end);
+    if (err != COIL_ERR_GOOD) goto fail;
+
+    if (gret.opcode == COIL_OP_GRET) {
+      cop_inline_range_t dst = {gret.operands, gret.next};
+      err = cop_inline_map(&cp, gret.offset);
+      if (err == COIL_ERR_GOOD) err = cop_inline_mov(&cp, sect, dst, callee, c->ret);
+      if (err != COIL_ERR_GOOD) goto fail;
+      pos = gret.next;
+    }
+
+    count++;
+  }
+
+  err = cop_inline_flush(&cp, &pending);
+  if (err != COIL_ERR_GOOD) goto fail;
+
+  // an offset that can not follow its target leaves the section as it was
+  if (count && !cop_inline_patch(&cp)) count = 0;
+  if (!count) coil_section_cleanup(out);
+
+  free(cp.map);
+  free(cp.refs);
+  *inlined = count;
+  return COIL_ERR_GOOD;
+
+fail:
+  free(cp.map);
+  free(cp.refs);
+  coil_section_cleanup(out);
+  return err;
+}
@@ -0,0 +1,88 @@
+/**
+* @file src/inline.h
+* @brief COIL IR inliner for the COIL Object Processor (COP)
+*
+* Inlines small functions into their callers before native code generation,
+* across sections of the same object. Each code section is a function
+* entered at its start.
+*
+* A callee is inlined when it
+*   - is straight line code ending in its only ret, with no call, br or jmp
+*   - takes its parameters in a gparam run at its entry and sets its return
+*     value, if any, with an sret right before the ret
+*   - writes no register the target preserves across calls
+*   - has at most the threshold number of instructions
+* The sparam run before the call and the gret after it are turned into movs
+* to and from the callee registers. The original IR is left untouched, the
+* inlined copy is only used for code generation.
+*/
+
+#ifndef __COP_INCLUDE_GUARD_INLINE_H
+#define __COP_INCLUDE_GUARD_INLINE_H
+
+#include <cop.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define COP_INLINE_PARAMS_MAX 16
+
+/**
+* @brief Byte range of a section
+*/
+typedef struct cop_inline_range_s {
+  coil_size_t start;
+  coil_size_t end;
+} cop_inline_range_t;
+
+/**
+* @brief What is known about a section as a callee
+*/
+typedef struct cop_inline_callee_s {
+  coil_u8_t state;                                    ///< COP_INLINE_UNKNOWN, COP_INLINE_NO or COP_INLINE_YES
+  coil_u8_t param_count;                              ///< Parameters read by the gparam run
+  coil_u8_t param_regs[COP_INLINE_PARAMS_MAX];        ///< Register read into by each gparam
+  cop_inline_range_t params[COP_INLINE_PARAMS_MAX];   ///< Destination operand of each gparam
+  cop_inline_range_t body;                            ///< Instructions between the gparam run and the sret or ret
+  cop_inline_range_t ret;                             ///< Value operand of the sret, empty if there is none
+} cop_inline_callee_t;
+
+#define COP_INLINE_UNKNOWN 0
+#define COP_INLINE_NO 1
+#define COP_INLINE_YES 2
+
+typedef struct cop_inline_s {
+  coil_object_t *obj;
+  coil_u32_t threshold;           ///< Largest callee body inlined, in instructions
+  coil_u32_t preserved;           ///< Registers the target preserves across calls
+  cop_inline_callee_t *callees;   ///< Indexed by section, analysed on first use
+} cop_inline_t;
+
+/**
+* @brief Prepare to inline calls between the sections of obj
+*
+* @param inl Inliner
+* @param obj Object holding the callers and callees
+* @param threshold Largest callee body inlined, in instructions
+* @param preserved Mask of the registers the target preserves across calls
+*/
+coil_err_t cop_inline_init(cop_inline_t *inl, coil_object_t *obj, coil_u32_t threshold, coil_u32_t preserved);
+
+void cop_inline_cleanup(cop_inline_t *inl);
+
+/**
+* @brief Inline the calls of a section
+*
+* @param inl Inliner
+* @param index Index of the caller section
+* @param out Initialized with the inlined copy if anything was inlined, otherwise left alone
+* @param inlined Number of call sites inlined
+*/
+coil_err_t cop_inline_section(cop_inline_t *inl, coil_u16_t index, coil_section_t *out, coil_size_t *inlined);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __COP_INCLUDE_GUARD_INLINE_H */
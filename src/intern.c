@@ -0,0 +1,129 @@
+#include <src/intern.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Word at a time multiply-xorshift hash, symbol names are mostly short
+// Only the high 32 bits are used, as the tag and for the home slot
+static coil_u64_t cop_intern_hash(const char *key, coil_size_t len) {
+  coil_u64_t h = 0x9E3779B97F4A7C15ull ^ (coil_u64_t)len;
+  coil_u64_t w;
+
+  while (len >= 8) {
+    memcpy(&w, key, 8);
+    h = (h ^ w) * 0xFF51AFD7ED558CCDull;
+    h ^= h >> 32;
+    key += 8;
+    len -= 8;
+  }
+
+  w = 0;
+  memcpy(&w, key, len);
+  h = (h ^ w) * 0xC4CEB9FE1A85EC53ull;
+  h ^= h >> 29;
+  return h;
+}
+
+coil_err_t cop_intern_init(cop_intern_t *tab, coil_size_t hint) {
+  coil_size_t slots = 16;
+
+  // keep the load factor at or below 1/2 without growing for hint entries
+  while (slots < hint * 2) slots <<= 1;
+
+  memset(tab, 0, sizeof(*tab));
+  tab->slots = calloc(slots, sizeof(cop_intern_slot_t));
+  if (!tab->slots) return COIL_ERR_NOMEM;
+  tab->mask = slots - 1;
+
+  tab->capacity = hint ? hint : 8;
+  tab->entries = malloc(tab->capacity * sizeof(cop_intern_entry_t));
+  if (!tab->entries) {
+    free(tab->slots);
+    tab->slots = NULL;
+    return COIL_ERR_NOMEM;
+  }
+
+  return COIL_ERR_GOOD;
+}
+
+void cop_intern_cleanup(cop_intern_t *tab) {
+  free(tab->slots);
+  free(tab->entries);
+  memset(tab, 0, sizeof(*tab));
+}
+
+// Double the slots, the tags and entries are reused so no key is hashed again
+static int cop_intern_grow(cop_intern_t *tab) {
+  coil_size_t mask = tab->mask * 2 + 1;
+  cop_intern_slot_t *slots = calloc(mask + 1, sizeof(cop_intern_slot_t));
+  if (!slots) return 0;
+
+  for (coil_size_t i = 0; i <= tab->mask; ++i) {
+    cop_intern_slot_t slot = tab->slots[i];
+    if (!slot.entry) continue;
+
+    coil_size_t at = slot.tag & mask;
+    while (slots[at].entry) at = (at + 1) & mask;
+    slots[at] = slot;
+  }
+
+  free(tab->slots);
+  tab->slots = slots;
+  tab->mask = mask;
+  return 1;
+}
+
+coil_u64_t *cop_intern_put(cop_intern_t *tab, const char *key, coil_size_t len, int *added) {
+  // grow at a load factor of 3/4
+  if ((tab->count + 1) * 4 > (tab->mask + 1) * 3 && !cop_intern_grow(tab)) return NULL;
+
+  coil_u64_t h = cop_intern_hash(key, len);
+  coil_u32_t tag = (coil_u32_t)(h >> 32);
+  coil_size_t at = tag & tab->mask;
+
+  for (;; at = (at + 1) & tab->mask) {
+    cop_intern_slot_t *slot = &tab->slots[at];
+    if (!slot->entry) break;
+
+    cop_intern_entry_t *e = &tab->entries[slot->entry - 1];
+    if (slot->tag == tag && e->len == len && memcmp(e->key, key, len) == 0) {
+      *added = 0;
+      return &e->value;
+    }
+  }
+
+  if (tab->count == tab->capacity) {
+    coil_size_t capacity = tab->capacity * 2;
+    cop_intern_entry_t *entries = realloc(tab->entries, capacity * sizeof(cop_intern_entry_t));
+    if (!entries) return NULL;
+    tab->entries = entries;
+    tab->capacity = capacity;
+  }
+
+  cop_intern_entry_t *e = &tab->entries[tab->count++];
+  e->key = key;
+  e->len = len;
+  e->value = 0;
+
+  tab->slots[at].tag = tag;
+  tab->slots[at].entry = (coil_u32_t)tab->count;
+
+  *added = 1;
+  return &e->value;
+}
+
+int cop_intern_find(const cop_intern_t *tab, const char *key, coil_size_t len, coil_u64_t *value) {
+  coil_u64_t h = cop_intern_hash(key, len);
+  coil_u32_t tag = (coil_u32_t)(h >> 32);
+  coil_size_t at = tag & tab->mask;
+
+  for (;; at = (at + 1) & tab->mask) {
+    const cop_intern_slot_t *slot = &tab->slots[at];
+    if (!slot->entry) return 0;
+
+    const cop_intern_entry_t *e = &tab->entries[slot->entry - 1];
+    if (slot->tag == tag && e->len == len && memcmp(e->key, key, len) == 0) {
+      *value = e->value;
+      return 1;
+    }
+  }
+}
@@ -0,0 +1,83 @@
+/**
+* @file src/intern.h
+* @brief String intern table for the COIL Object Processor (COP)
+*
+* Open addressing hash table with linear probing mapping strings to a
+* 64 bit value, used for symbol lookups and string deduplication. Probing
+* walks a dense array of 8 byte slots holding a hash tag and an entry index,
+* the keys are only touched when the tags match.
+*
+* The table does not copy keys, they must outlive the table.
+*/
+
+#ifndef __COP_INCLUDE_GUARD_INTERN_H
+#define __COP_INCLUDE_GUARD_INTERN_H
+
+#include <cop.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct cop_intern_slot_s {
+  coil_u32_t tag;     ///< High bits of the key hash
+  coil_u32_t entry;   ///< Index of the entry plus one, 0 when the slot is empty
+} cop_intern_slot_t;
+
+typedef struct cop_intern_entry_s {
+  const char *key;
+  coil_size_t len;
+  coil_u64_t value;
+} cop_intern_entry_t;
+
+typedef struct cop_intern_s {
+  cop_intern_slot_t *slots;
+  coil_size_t mask;             ///< Slot count - 1, the slot count is a power of two
+  cop_intern_entry_t *entries;  ///< Entries in insertion order
+  coil_size_t count;
+  coil_size_t capacity;         ///< Entries allocated
+} cop_intern_t;
+
+/**
+* @brief Initialize an empty table
+*
+* @param tab Table
+* @param hint Expected number of entries, the table grows past it as needed
+*/
+coil_err_t cop_intern_init(cop_intern_t *tab, coil_size_t hint);
+
+/**
+* @brief Free the table, the keys are left alone
+*/
+void cop_intern_cleanup(cop_intern_t *tab);
+
+/**
+* @brief Find or add a key
+*
+* @param tab Table
+* @param key Key bytes, referenced by the table from now on if added
+* @param len Key length
+* @param added Set to 1 if the key was new, its value is then 0 for the caller to fill
+*
+* @return coil_u64_t* Value of the key, valid until the next put
+* @return coil_u64_t* NULL if out of memory
+*/
+coil_u64_t *cop_intern_put(cop_intern_t *tab, const char *key, coil_size_t len, int *added);
+
+/**
+* @brief Find a key
+*
+* @param tab Table
+* @param key Key bytes
+* @param len Key length
+* @param value Value of the key if found
+*
+* @return int Nonzero if the key was found
+*/
+int cop_intern_find(const cop_intern_t *tab, const char *key, coil_size_t len, coil_u64_t *value);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __COP_INCLUDE_GUARD_INTERN_H */
@@ -0,0 +1,76 @@
+#include <src/ir.h>
+
+// COIL instructions are encoded as
+//   [opcode: u8][operand count: u8][operand]...
+// where each operand is a header followed by its data.
+
+coil_size_t cop_ir_decode(coil_section_t *sect, coil_size_t pos, cop_ir_instr_t *instr) {
+  if (pos + 2 > sect->size) {
+    coil_log(COIL_LEVEL_ERROR, "Truncated instruction at offset %zu", (size_t)pos);
+    return 0;
+  }
+
+  instr->offset = pos;
+  instr->opcode = sect->data[pos];
+  instr->operand_count = sect->data[pos + 1];
+  instr->operands = pos + 2;
+
+  // Skip over the operands, the values are only needed to find the next instruction
+  pos = instr->operands;
+  for (coil_u8_t i = 0; i < instr->operand_count; ++i) {
+    coil_operand_header_t op_header;
+    coil_u64_t value;
+
+    pos = cop_ir_operand(sect, pos, &op_header, &value, NULL);
+    if (!pos) return 0;
+  }
+
+  instr->next = pos;
+  return pos;
+}
+
+coil_size_t cop_ir_operand(coil_section_t *sect, coil_size_t pos, coil_operand_header_t *header, coil_u64_t *value, coil_size_t *valsize) {
+  coil_offset_t offset;
+  coil_size_t size;
+
+  *value = 0;
+  pos = coil_operand_decode(sect, pos, header, &offset);
+  if (!pos) return 0;
+
+  pos = coil_operand_decode_data(sect, pos, value, sizeof(*value), &size, header);
+  if (!pos) return 0;
+
+  if (valsize) *valsize = size;
+  return pos;
+}
+
+int cop_ir_branch_target(coil_section_t *sect, const cop_ir_instr_t *instr, coil_size_t *target) {
+  if (instr->opcode != COIL_OP_BR && instr->opcode != COIL_OP_JMP) return 0;
+
+  // The target is the first operand, br carries its condition after it
+  if (instr->operand_count == 0) return 0;
+
+  coil_operand_header_t op_header;
+  coil_u64_t value;
+
+  // Only offsets within the section are local, symbols are resolved by the linker
+  if (!cop_ir_operand(sect, instr->operands, &op_header, &value, NULL)) return 0;
+  if (op_header.type != COIL_TYPEOP_OFF || value >= sect->size) return 0;
+
+  *target = (coil_size_t)value;
+  return 1;
+}
+
+int cop_ir_writes(coil_u8_t opcode) {
+  switch (opcode) {
+    case COIL_OP_MOV: case COIL_OP_POP: case COIL_OP_LEA:
+    case COIL_OP_ADD: case COIL_OP_SUB: case COIL_OP_MUL: case COIL_OP_DIV: case COIL_OP_MOD:
+    case COIL_OP_INC: case COIL_OP_DEC: case COIL_OP_NEG:
+    case COIL_OP_AND: case COIL_OP_OR: case COIL_OP_XOR: case COIL_OP_NOT:
+    case COIL_OP_SHL: case COIL_OP_SHR: case COIL_OP_SAL: case COIL_OP_SAR:
+    case COIL_OP_CVT: case COIL_OP_GPARAM: case COIL_OP_GRET:
+      return 1;
+    default:
+      return 0;
+  }
+}
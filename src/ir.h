@@ -0,0 +1,81 @@
+/**
+* @file src/ir.h
+* @brief COIL IR walking helpers for the COIL Object Processor (COP)
+*
+* Used by passes that need to look at a whole section before, or instead of,
+* lowering it instruction by instruction.
+*/
+
+#ifndef __COP_INCLUDE_GUARD_IR_H
+#define __COP_INCLUDE_GUARD_IR_H
+
+#include <cop.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+* @brief A decoded COIL instruction
+*/
+typedef struct cop_ir_instr_s {
+  coil_u8_t opcode;         ///< COIL opcode
+  coil_u8_t operand_count;  ///< Number of operands following the opcode
+  coil_size_t offset;       ///< Section offset of the opcode
+  coil_size_t operands;     ///< Section offset of the first operand
+  coil_size_t next;         ///< Section offset of the next instruction
+} cop_ir_instr_t;
+
+/**
+* @brief Decode the instruction at pos
+*
+* @param sect COIL section
+* @param pos Offset of the instruction within sect
+* @param instr Decoded instruction
+*
+* @return coil_size_t Offset of the next instruction
+* @return coil_size_t 0 on failure, see coil_error_get_last
+*/
+coil_size_t cop_ir_decode(coil_section_t *sect, coil_size_t pos, cop_ir_instr_t *instr);
+
+/**
+* @brief Decode the operand at pos
+*
+* Values wider than 64 bits are truncated.
+*
+* @param sect COIL section
+* @param pos Offset of the operand within sect
+* @param header Decoded operand header
+* @param value Decoded operand value
+* @param valsize Size of the encoded value, which ends at the returned offset, may be NULL
+*
+* @return coil_size_t Offset past the operand
+* @return coil_size_t 0 on failure, see coil_error_get_last
+*/
+coil_size_t cop_ir_operand(coil_section_t *sect, coil_size_t pos, coil_operand_header_t *header, coil_u64_t *value, coil_size_t *valsize);
+
+/**
+* @brief Get the in-section target of a br or jmp
+*
+* @param sect COIL section
+* @param instr Decoded br or jmp instruction
+* @param target Section offset of the target instruction
+*
+* @return int Nonzero if the target is an instruction of sect
+*/
+int cop_ir_branch_target(coil_section_t *sect, const cop_ir_instr_t *instr, coil_size_t *target);
+
+/**
+* @brief Check if an instruction writes its first operand
+*
+* @param opcode COIL opcode
+*
+* @return int Nonzero if the first operand is written
+*/
+int cop_ir_writes(coil_u8_t opcode);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __COP_INCLUDE_GUARD_IR_H */
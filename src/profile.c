@@ -0,0 +1,82 @@
+#include <src/profile.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct cop_profile_entry_s {
+  coil_u64_t calls;
+  coil_u64_t cycles;
+  coil_u64_t name;
+} cop_profile_entry_t;
+
+static coil_u64_t cop_profile_read64(const coil_byte_t *p) {
+  coil_u64_t v = 0;
+  for (int i = 7; i >= 0; --i) v = (v << 8) | p[i];
+  return v;
+}
+
+// Most cycles first
+static int cop_profile_cmp(const void *a, const void *b) {
+  const cop_profile_entry_t *x = a, *y = b;
+  return (x->cycles < y->cycles) - (x->cycles > y->cycles);
+}
+
+coil_err_t cop_profile_add(coil_section_t *prof, coil_u64_t name, coil_size_t *offset) {
+  coil_byte_t record[COP_PROFILE_RECORD] = {0};
+  for (int i = 0; i < 8; ++i) record[COP_PROFILE_NAME + i] = (coil_byte_t)(name >> (i * 8));
+
+  *offset = prof->windex;
+  return coil_section_write(prof, record, sizeof(record), NULL);
+}
+
+cop_err_t cop_profile_report(FILE *stream, coil_object_t *obj, const void *counters, coil_size_t size) {
+  const coil_byte_t *dump = counters;
+  coil_section_t *prof = NULL;
+
+  for (coil_u16_t i = 0; i < obj->section_count && !prof; ++i) {
+    coil_size_t len;
+    const char *name = coil_object_get_string(obj, obj->sectheaders[i].name, &len);
+    if (name && len == sizeof(COP_PROFILE_SECTION) - 1 && memcmp(name, COP_PROFILE_SECTION, len) == 0) prof = &obj->sections[i];
+  }
+  if (!prof) {
+    coil_log(COIL_LEVEL_ERROR, "Object was not built with --instrument");
+    return COIL_ERR_NOTFOUND;
+  }
+  if (size != prof->size || size % COP_PROFILE_RECORD) {
+    coil_log(COIL_LEVEL_ERROR, "Counter dump is %zu bytes, expected %zu", (size_t)size, (size_t)prof->size);
+    return COIL_ERR_FORMAT;
+  }
+
+  coil_size_t count = size / COP_PROFILE_RECORD;
+  cop_profile_entry_t *entries = malloc((count ? count : 1) * sizeof(cop_profile_entry_t));
+  if (!entries) return COIL_ERR_NOMEM;
+
+  // names come from the object, the program only writes the counters
+  for (coil_size_t i = 0; i < count; ++i) {
+    const coil_byte_t *record = dump + i * COP_PROFILE_RECORD;
+    entries[i].calls = cop_profile_read64(record + COP_PROFILE_CALLS);
+    entries[i].cycles = cop_profile_read64(record + COP_PROFILE_CYCLES);
+    entries[i].name = cop_profile_read64(prof->data + i * COP_PROFILE_RECORD + COP_PROFILE_NAME);
+  }
+  qsort(entries, count, sizeof(cop_profile_entry_t), cop_profile_cmp);
+
+  // cycles are inclusive of callees so they do not add up to a total
+  fprintf(stream, "%20s %20s %14s  %s\n", "cycles", "calls", "cycles/call", "function");
+  for (coil_size_t i = 0; i < count; ++i) {
+    const cop_profile_entry_t *e = &entries[i];
+    coil_size_t len;
+
+    const char *name = coil_object_get_string(obj, e->name, &len);
+    if (!name) {
+      name = "?";
+      len = 1;
+    }
+
+    fprintf(stream, "%20llu %20llu %14.1f  %.*s\n",
+      (unsigned long long)e->cycles, (unsigned long long)e->calls,
+      e->calls ? (double)e->cycles / (double)e->calls : 0.0,
+      (int)len, name);
+  }
+
+  free(entries);
+  return COIL_ERR_GOOD;
+}
@@ -0,0 +1,53 @@
+/**
+* @file src/profile.h
+* @brief Function probes for the COIL Object Processor (COP)
+*
+* In instrument mode every probed function gets a counter record in the
+* COP_PROFILE_SECTION section of the output object. The probe at the entry
+* of the function counts the call and subtracts the cycle counter from the
+* cycles of the record, the probe before each return (and tail call) adds
+* it back, so the record holds the cycles spent inside the function and
+* everything it calls. Recursive calls are counted again by each level.
+*
+* A record is three little endian u64
+*   [calls][cycles][name]
+* where name is the offset of the function name in the string table. The
+* section starts at COP_PROFILE_SYMBOL and ends at COP_PROFILE_SYMBOL_END,
+* a program dumps the bytes in between and cop_profile_report turns them
+* into a report.
+*/
+
+#ifndef __COP_INCLUDE_GUARD_PROFILE_H
+#define __COP_INCLUDE_GUARD_PROFILE_H
+
+#include <cop.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define COP_PROFILE_SECTION ".cop.prof"
+#define COP_PROFILE_SYMBOL "__cop_prof"
+#define COP_PROFILE_SYMBOL_END "__cop_prof_end"
+
+#define COP_PROFILE_CALLS 0
+#define COP_PROFILE_CYCLES 8
+#define COP_PROFILE_NAME 16
+#define COP_PROFILE_RECORD 24
+
+/**
+* @brief Append a zeroed counter record for a function
+*
+* @param prof Counter section
+* @param name String table offset of the function name
+* @param offset Offset of the new record in prof
+*
+* @return coil_err_t COIL_ERR_GOOD on success
+*/
+coil_err_t cop_profile_add(coil_section_t *prof, coil_u64_t name, coil_size_t *offset);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __COP_INCLUDE_GUARD_PROFILE_H */
@@ -0,0 +1,61 @@
+#include <src/reach.h>
+#include <src/ir.h>
+#include <stdlib.h>
+#include <string.h>
+
+coil_err_t cop_reach_mark(coil_object_t *obj, const coil_u16_t *roots, coil_size_t root_count, coil_u8_t *reachable) {
+  coil_u16_t *work;
+  coil_size_t count = 0;
+
+  memset(reachable, 0, obj->section_count);
+
+  // every section enters the worklist at most once
+  work = malloc((obj->section_count ? obj->section_count : 1) * sizeof(coil_u16_t));
+  if (!work) return COIL_ERR_NOMEM;
+
+  for (coil_size_t i = 0; i < root_count; ++i) {
+    if (roots[i] >= obj->section_count || reachable[roots[i]]) continue;
+    reachable[roots[i]] = 1;
+    work[count++] = roots[i];
+  }
+
+  while (count) {
+    coil_u16_t index = work[--count];
+    coil_section_t *sect = &obj->sections[index];
+    coil_size_t pos = 0;
+    cop_ir_instr_t instr;
+
+    if (!(obj->sectheaders[index].flags & COIL_SECTION_FLAG_CODE)) continue;
+
+    while (pos < sect->size) {
+      pos = cop_ir_decode(sect, pos, &instr);
+      if (!pos) {
+        free(work);
+        return coil_error_get_last();
+      }
+
+      // any symbol operand may be a function address, e.g. a callback passed with sparam or stored with mov
+      coil_size_t oppos = instr.operands;
+      for (coil_u8_t i = 0; i < instr.operand_count; ++i) {
+        coil_operand_header_t op_header;
+        coil_u64_t value;
+
+        oppos = cop_ir_operand(sect, oppos, &op_header, &value, NULL);
+        if (!oppos) {
+          free(work);
+          return coil_error_get_last();
+        }
+        if (op_header.type != COIL_TYPEOP_SYM || value >= obj->symbol_count) continue;
+
+        // undefined symbols live in other objects
+        coil_u16_t target = obj->symbols[value].section;
+        if (target >= obj->section_count || reachable[target]) continue;
+        reachable[target] = 1;
+        work[count++] = target;
+      }
+    }
+  }
+
+  free(work);
+  return COIL_ERR_GOOD;
+}
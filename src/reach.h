@@ -0,0 +1,35 @@
+/**
+* @file src/reach.h
+* @brief Reachability of code sections for the COIL Object Processor (COP)
+*
+* Finds the code sections reachable from a set of root sections by following
+* every symbol operand of their instructions. Only reachable sections need
+* native code, the others are kept as IR for the linker to lower if
+* it ever needs them. References from data sections are not followed, name
+* the functions they point at as roots.
+*/
+
+#ifndef __COP_INCLUDE_GUARD_REACH_H
+#define __COP_INCLUDE_GUARD_REACH_H
+
+#include <cop.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+* @brief Mark the sections reachable from roots
+*
+* @param obj Object holding the sections
+* @param roots Indices of the root sections
+* @param root_count Number of roots
+* @param reachable One byte per section of obj, set to 1 for every reachable section
+*/
+coil_err_t cop_reach_mark(coil_object_t *obj, const coil_u16_t *roots, coil_size_t root_count, coil_u8_t *reachable);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __COP_INCLUDE_GUARD_REACH_H */
@@ -0,0 +1,119 @@
+// The parts of libcoil the unit tests use, so they run without it and build their own IR
+//
+// Operands are encoded as
+//   [type: u8][value type: u8][size: u8][value: size bytes, little endian]
+// which is all cop_ir_operand needs to walk and read them.
+
+#include "test.h"
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+
+static coil_err_t coil_stub_last = COIL_ERR_GOOD;
+
+test_reloc_t test_relocs[TEST_RELOCS_MAX];
+coil_size_t test_reloc_count;
+const char *test_strings;
+coil_size_t test_strings_size;
+
+void coil_log(int level, const char *format, ...) {
+  (void)level;
+  (void)format;
+}
+
+coil_err_t coil_error_get_last(void) {
+  return coil_stub_last;
+}
+
+coil_err_t coil_section_init(coil_section_t *sect, coil_size_t capacity) {
+  memset(sect, 0, sizeof(*sect));
+  sect->data = malloc(capacity ? capacity : 1);
+  if (!sect->data) return COIL_ERR_NOMEM;
+  sect->capacity = capacity;
+  return COIL_ERR_GOOD;
+}
+
+void coil_section_cleanup(coil_section_t *sect) {
+  free(sect->data);
+  memset(sect, 0, sizeof(*sect));
+}
+
+coil_err_t coil_section_write(coil_section_t *sect, coil_byte_t *data, coil_size_t size, coil_size_t *written) {
+  if (sect->windex + size > sect->capacity) {
+    coil_size_t capacity = (sect->windex + size) * 2;
+    coil_byte_t *grown = realloc(sect->data, capacity);
+    if (!grown) return COIL_ERR_NOMEM;
+    sect->data = grown;
+    sect->capacity = capacity;
+  }
+
+  memcpy(sect->data + sect->windex, data, size);
+  sect->windex += size;
+  if (sect->windex > sect->size) sect->size = sect->windex;
+  if (written) *written = size;
+  return COIL_ERR_GOOD;
+}
+
+coil_err_t coil_section_add_reloc(coil_section_t *sect, coil_size_t offset, coil_u64_t symbol, coil_u8_t type, int64_t addend) {
+  (void)sect;
+  if (test_reloc_count == TEST_RELOCS_MAX) return COIL_ERR_NOMEM;
+
+  test_reloc_t *reloc = &test_relocs[test_reloc_count++];
+  reloc->offset = offset;
+  reloc->symbol = symbol;
+  reloc->type = type;
+  reloc->addend = addend;
+  return COIL_ERR_GOOD;
+}
+
+// Strings are read from test_strings, a string offset is an offset into it
+const char *coil_object_get_string(coil_object_t *obj, coil_u64_t offset, coil_size_t *len) {
+  (void)obj;
+  if (!test_strings || offset >= test_strings_size) {
+    coil_stub_last = COIL_ERR_NOTFOUND;
+    return NULL;
+  }
+
+  *len = strlen(test_strings + offset);
+  return test_strings + offset;
+}
+
+coil_size_t coil_operand_decode(coil_section_t *sect, coil_size_t pos, coil_operand_header_t *header, coil_offset_t *offset) {
+  if (pos + 3 > sect->size) {
+    coil_stub_last = COIL_ERR_FORMAT;
+    return 0;
+  }
+
+  header->type = sect->data[pos];
+  header->value_type = sect->data[pos + 1];
+  *offset = 0;
+  return pos + 2;
+}
+
+coil_size_t coil_operand_decode_data(coil_section_t *sect, coil_size_t pos, void *value, coil_size_t capacity, coil_size_t *valsize, coil_operand_header_t *header) {
+  (void)header;
+
+  coil_size_t size = sect->data[pos];
+  if (size > capacity || pos + 1 + size > sect->size) {
+    coil_stub_last = COIL_ERR_FORMAT;
+    return 0;
+  }
+
+  memset(value, 0, capacity);
+  memcpy(value, sect->data + pos + 1, size);
+  *valsize = size;
+  return pos + 1 + size;
+}
+
+int test_failures;
+
+coil_err_t test_instr(coil_section_t *sect, coil_u8_t opcode, coil_u8_t operand_count) {
+  coil_byte_t code[] = {opcode, operand_count};
+  return coil_section_write(sect, code, sizeof(code), NULL);
+}
+
+coil_err_t test_operand(coil_section_t *sect, coil_u8_t type, coil_u8_t value_type, coil_u64_t value, coil_u8_t size) {
+  coil_byte_t code[3 + 8] = {type, value_type, size};
+  for (coil_u8_t i = 0; i < size; ++i) code[3 + i] = (coil_byte_t)(value >> (i * 8));
+  return coil_section_write(sect, code, 3 + size, NULL);
+}
@@ -0,0 +1,76 @@
+/**
+* @file tests/test.h
+* @brief Checks and IR builders shared by the COP unit tests
+*/
+
+#ifndef __COP_INCLUDE_GUARD_TEST_H
+#define __COP_INCLUDE_GUARD_TEST_H
+
+#include <cop.h>
+
+/**
+* @brief Count a failed check and report where it failed
+*/
+#define TEST_CHECK(cond) do { \
+    if (!(cond)) { \
+      fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+      test_failures++; \
+    } \
+  } while (0)
+
+/**
+* @brief Exit status of a test program
+*/
+#define TEST_RESULT() (test_failures ? (fprintf(stderr, "%d checks failed\n", test_failures), 1) : 0)
+
+/**
+* @brief Failed checks so far
+*/
+extern int test_failures;
+
+/**
+* @brief Relocations recorded by coil_section_add_reloc
+*/
+#define TEST_RELOCS_MAX 64
+
+typedef struct test_reloc_s {
+  coil_size_t offset;
+  coil_u64_t symbol;
+  coil_u8_t type;
+  int64_t addend;
+} test_reloc_t;
+
+extern test_reloc_t test_relocs[TEST_RELOCS_MAX];
+extern coil_size_t test_reloc_count;
+
+/**
+* @brief String table read by coil_object_get_string, NUL terminated strings at their offsets
+*/
+extern const char *test_strings;
+extern coil_size_t test_strings_size;
+
+/**
+* @brief Append an instruction header to an IR section
+*
+* @param sect Section to append to
+* @param opcode COIL opcode
+* @param operand_count Operands that follow
+*
+* @return coil_err_t COIL_ERR_GOOD on success
+*/
+coil_err_t test_instr(coil_section_t *sect, coil_u8_t opcode, coil_u8_t operand_count);
+
+/**
+* @brief Append an operand to an IR section in the encoding of tests/coil_stub.c
+*
+* @param sect Section to append to
+* @param type COIL_TYPEOP_*
+* @param value_type COIL_VAL_*
+* @param value Value of the operand
+* @param size Bytes of the value, at most 8
+*
+* @return coil_err_t COIL_ERR_GOOD on success
+*/
+coil_err_t test_operand(coil_section_t *sect, coil_u8_t type, coil_u8_t value_type, coil_u64_t value, coil_u8_t size);
+
+#endif /* __COP_INCLUDE_GUARD_TEST_H */
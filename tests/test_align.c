@@ -0,0 +1,124 @@
+// Loop head padding of the x86 generators
+
+#include "test.h"
+#include <src/codegen.h>
+#include <string.h>
+
+cop_codegen_state_t cop_codegen_state;
+
+#include "../src/codegen/cpu/x86/x86_align.h"
+
+// Length of the NOP at code, 0 for anything but 90, 66 90 and 0F 1F /0 with 32 bit addressing
+static coil_size_t nop_length(const coil_byte_t *code) {
+  coil_size_t len = 0;
+
+  if (code[len] == 0x66) len++;
+  if (code[len] == 0x90) return len + 1;
+  if (code[len] != 0x0F || code[len + 1] != 0x1F) return 0;
+  len += 2;
+
+  coil_byte_t modrm = code[len++];
+  if ((modrm & 0x38) != 0 || (modrm & 0xC0) == 0xC0) return 0;
+  if ((modrm & 7) == 4) len++;
+  if ((modrm & 0xC0) == 0x40) len += 1;
+  if ((modrm & 0xC0) == 0x80) len += 4;
+  return len;
+}
+
+static void test_nops(void) {
+  // every entry is one instruction of its length
+  for (coil_size_t n = 1; n <= X86_NOP_MAX32; ++n) {
+    const coil_byte_t *nop = __x86_nop32[n - 1];
+    TEST_CHECK(nop_length(nop) == n);
+    for (coil_size_t i = n; i < X86_NOP_MAX32; ++i) TEST_CHECK(nop[i] == 0);
+  }
+
+  // 16 bit code runs on processors without 0F 1F or the 66 prefix
+  TEST_CHECK(X86_NOP_MAX16 == 1 && __x86_nop16[0][0] == 0x90);
+}
+
+static void test_fill(coil_section_t *native) {
+  for (coil_size_t count = 0; count < 40; ++count) {
+    native->windex = native->size = 0;
+    TEST_CHECK(__x86_codegen_nop_fill(native, count, &__x86_nop32[0][0], X86_NOP_MAX32) == COIL_ERR_GOOD);
+    TEST_CHECK(native->size == count);
+
+    // the longest NOPs first, so the padding decodes as few instructions as possible
+    coil_size_t pos = 0, instrs = 0;
+    while (pos < native->size) {
+      coil_size_t len = nop_length(native->data + pos);
+      TEST_CHECK(len == (count - pos < X86_NOP_MAX32 ? count - pos : X86_NOP_MAX32));
+      if (!len) break;
+      pos += len;
+      instrs++;
+    }
+    TEST_CHECK(pos == count && instrs == (count + X86_NOP_MAX32 - 1) / X86_NOP_MAX32);
+
+    native->windex = native->size = 0;
+    TEST_CHECK(__x86_codegen_nop_fill(native, count, &__x86_nop16[0][0], X86_NOP_MAX16) == COIL_ERR_GOOD);
+    TEST_CHECK(native->size == count);
+    for (coil_size_t i = 0; i < count; ++i) TEST_CHECK(native->data[i] == 0x90);
+  }
+}
+
+// Pad from offset at within a section aligned to section_align, the padding emitted
+static coil_size_t pad(coil_section_t *native, coil_size_t at, coil_u32_t align, coil_u32_t section_align) {
+  coil_byte_t zero[64] = {0};
+
+  native->windex = native->size = 0;
+  coil_section_write(native, zero, at, NULL);
+  cop_codegen_state.section_align = section_align;
+  TEST_CHECK(__x86_codegen_align32(native, align) == COIL_ERR_GOOD);
+  return native->windex - at;
+}
+
+static void test_align(coil_section_t *native) {
+  cop_config_t conf = {0};
+  cop_stats_t stats = {0};
+  cop_codegen_state.conf = &conf;
+  cop_codegen_state.stats = &stats;
+
+  // up to the next multiple, nothing when already aligned or when alignment is off
+  TEST_CHECK(pad(native, 5, 16, 16) == 11);
+  TEST_CHECK(pad(native, 32, 16, 16) == 0);
+  TEST_CHECK(pad(native, 5, 0, 16) == 0);
+  TEST_CHECK(pad(native, 5, 1, 16) == 0);
+  TEST_CHECK(stats.align_points == 1 && stats.align_bytes == 11 && stats.align_skipped == 0);
+
+  // no further than the section, which is only placed at a multiple of its own alignment
+  TEST_CHECK(pad(native, 5, 32, 8) == 3);
+  TEST_CHECK(pad(native, 5, 32, 1) == 0);
+
+  // the max skip leaves a point unpadded rather than padding it part of the way
+  memset(&stats, 0, sizeof(stats));
+  conf.align_max_skip = 7;
+  TEST_CHECK(pad(native, 9, 16, 16) == 7);
+  TEST_CHECK(pad(native, 8, 16, 16) == 0);
+  TEST_CHECK(stats.align_points == 1 && stats.align_skipped == 1 && stats.align_bytes == 7);
+  conf.align_max_skip = 0;
+
+  // the budget counts every point of the section, the function entry included
+  memset(&stats, 0, sizeof(stats));
+  conf.align_budget = 20;
+  cop_codegen_state.align_used = 8;
+  TEST_CHECK(pad(native, 4, 16, 16) == 12);
+  TEST_CHECK(cop_codegen_state.align_used == 20);
+  TEST_CHECK(pad(native, 15, 16, 16) == 0);
+  TEST_CHECK(stats.align_points == 1 && stats.align_skipped == 1 && stats.align_bytes == 12);
+  conf.align_budget = 0;
+  cop_codegen_state.align_used = 0;
+}
+
+int main(void) {
+  coil_section_t native;
+
+  TEST_CHECK(coil_section_init(&native, 64) == COIL_ERR_GOOD);
+  cop_codegen_state.native = &native;
+
+  test_nops();
+  test_fill(&native);
+  test_align(&native);
+
+  coil_section_cleanup(&native);
+  return TEST_RESULT();
+}
@@ -0,0 +1,130 @@
+#include "test.h"
+#include <src/compress.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define GUARD 64
+#define GUARD_BYTE 0xA5
+
+// Data with runs, short repeats and far matches so every sequence form is produced
+static void fill(coil_byte_t *data, coil_size_t size, int mode) {
+  for (coil_size_t i = 0; i < size; ++i) {
+    switch (mode) {
+      case 0: data[i] = (coil_byte_t)rand(); break;
+      case 1: data[i] = (coil_byte_t)(i % 7); break;
+      case 2: data[i] = (coil_byte_t)"abcab"[rand() % 5]; break;
+      default: data[i] = i > 300 && rand() % 4 ? data[i - 1 - rand() % 300] : (coil_byte_t)rand(); break;
+    }
+  }
+}
+
+// Decompress into a buffer of exactly the claimed size followed by a guard
+static coil_err_t inflate(const coil_byte_t *packed, coil_size_t size, coil_byte_t *out, coil_size_t raw) {
+  memset(out + raw, GUARD_BYTE, GUARD);
+  coil_err_t err = cop_lz_decompress(packed, size, out);
+  for (coil_size_t i = 0; i < GUARD; ++i) TEST_CHECK(out[raw + i] == GUARD_BYTE);
+  return err;
+}
+
+static void test_round_trip(void) {
+  for (int t = 0; t < 2000; ++t) {
+    coil_size_t size = (coil_size_t)(rand() % (t < 1600 ? 300 : 100000));
+    coil_byte_t *data = malloc(size + 1);
+    coil_byte_t *packed = malloc(COP_LZ_BOUND(size));
+    coil_byte_t *out = malloc(size + GUARD);
+    fill(data, size, t % 4);
+
+    coil_size_t packed_size = cop_lz_compress(data, size, packed);
+    TEST_CHECK(packed_size <= COP_LZ_BOUND(size));
+    TEST_CHECK(cop_lz_size(packed, packed_size) == size);
+    TEST_CHECK(inflate(packed, packed_size, out, size) == COIL_ERR_GOOD);
+    TEST_CHECK(memcmp(data, out, size) == 0);
+
+    // every sequence ends with literals, so a cut anywhere leaves the output short
+    if (size) {
+      coil_size_t cut = COP_LZ_HEADER + (coil_size_t)rand() % (packed_size - COP_LZ_HEADER);
+      TEST_CHECK(inflate(packed, cut, out, size) == COIL_ERR_FORMAT);
+    }
+
+    // flipped bits may decode to other data but never past the output
+    for (int k = 0; k < 16 && packed_size > COP_LZ_HEADER; ++k) {
+      coil_byte_t *bad = malloc(packed_size);
+      memcpy(bad, packed, packed_size);
+      bad[COP_LZ_HEADER + (coil_size_t)rand() % (packed_size - COP_LZ_HEADER)] ^= (coil_byte_t)(1 + rand() % 255);
+      inflate(bad, packed_size, out, size);
+      free(bad);
+    }
+
+    free(data);
+    free(packed);
+    free(out);
+  }
+}
+
+static void test_corrupt(void) {
+  static const struct {
+    coil_byte_t data[16];
+    coil_size_t size;
+  } cases[] = {
+    {{8, 0, 0, 0, 0x14, 'a', 0, 0}, 8},         // match offset 0
+    {{8, 0, 0, 0, 0x14, 'a', 2, 0}, 8},         // match before the start of the output
+    {{8, 0, 0, 0, 0x1F, 'a', 1, 0, 255}, 9},    // match length runs past the input
+    {{2, 0, 0, 0, 0x14, 'a', 1, 0}, 8},         // match runs past the output
+    {{1, 0, 0, 0, 0x20, 'a'}, 6},               // literals run past the input
+    {{1, 0, 0, 0, 0x20, 'a', 'b'}, 7},          // literals run past the output
+    {{3, 0, 0, 0, 0x10, 'a'}, 6},               // output shorter than the header says
+    {{1, 0, 0}, 3},                             // no header
+  };
+  coil_byte_t out[16 + GUARD];
+
+  for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); ++i) {
+    coil_size_t raw = cop_lz_size(cases[i].data, cases[i].size);
+    TEST_CHECK(raw <= 16);
+    if (raw > 16) continue;
+    TEST_CHECK(inflate(cases[i].data, cases[i].size, out, raw) == COIL_ERR_FORMAT);
+  }
+}
+
+static void test_section(void) {
+  coil_section_header_t header = {0};
+  coil_section_t sect;
+  coil_byte_t data[4096];
+
+  fill(data, sizeof(data), 1);
+  TEST_CHECK(coil_section_init(&sect, 16) == COIL_ERR_GOOD);
+  TEST_CHECK(coil_section_write(&sect, data, sizeof(data), NULL) == COIL_ERR_GOOD);
+
+  TEST_CHECK(cop_section_compress(&header, &sect) == COIL_ERR_GOOD);
+  TEST_CHECK(header.flags & COP_SECTION_FLAG_COMPRESSED);
+  TEST_CHECK(sect.size < sizeof(data));
+  TEST_CHECK(sect.windex == sect.size);
+
+  // compressing twice leaves the section alone
+  coil_size_t packed_size = sect.size;
+  TEST_CHECK(cop_section_compress(&header, &sect) == COIL_ERR_GOOD);
+  TEST_CHECK(sect.size == packed_size);
+
+  TEST_CHECK(cop_section_decompress(&header, &sect) == COIL_ERR_GOOD);
+  TEST_CHECK(!(header.flags & COP_SECTION_FLAG_COMPRESSED));
+  TEST_CHECK(sect.size == sizeof(data) && memcmp(sect.data, data, sizeof(data)) == 0);
+
+  coil_section_cleanup(&sect);
+
+  // incompressible data is kept as it is
+  fill(data, sizeof(data), 0);
+  header.flags = 0;
+  TEST_CHECK(coil_section_init(&sect, 16) == COIL_ERR_GOOD);
+  TEST_CHECK(coil_section_write(&sect, data, sizeof(data), NULL) == COIL_ERR_GOOD);
+  TEST_CHECK(cop_section_compress(&header, &sect) == COIL_ERR_GOOD);
+  TEST_CHECK(!(header.flags & COP_SECTION_FLAG_COMPRESSED));
+  TEST_CHECK(sect.size == sizeof(data) && memcmp(sect.data, data, sizeof(data)) == 0);
+  coil_section_cleanup(&sect);
+}
+
+int main(void) {
+  srand(1);
+  test_round_trip();
+  test_corrupt();
+  test_section();
+  return TEST_RESULT();
+}
@@ -0,0 +1,192 @@
+#include "test.h"
+#include <src/inline.h>
+#include <src/ir.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define CALLER 0
+#define CALLEE 1
+
+typedef struct test_program_s {
+  coil_section_header_t headers[2];
+  coil_section_t sections[2];
+  coil_symbol_t symbol;
+  coil_object_t obj;
+  coil_size_t ret_at;   // offset of the ret of the caller
+  coil_size_t call_at;  // offset of the first sparam of the call
+} test_program_t;
+
+static void reg(coil_section_t *sect, coil_u64_t r) {
+  test_operand(sect, COIL_TYPEOP_REG, COIL_VAL_U64, r, 1);
+}
+
+// caller:  nop; sparam a; sparam b; call callee; gret r2; br ret; br call; ret
+// callee:  gparam r7; gparam r6; add r7, r6; sret r7; ret
+static void build(test_program_t *p, coil_u64_t a, coil_u8_t a_type, coil_u64_t b, coil_u8_t b_type) {
+  coil_section_t *caller = &p->sections[CALLER], *callee = &p->sections[CALLEE];
+  coil_size_t br_fwd, br_back;
+
+  memset(p, 0, sizeof(*p));
+  coil_section_init(caller, 64);
+  coil_section_init(callee, 64);
+
+  test_instr(caller, COIL_OP_NOP, 0);
+  p->call_at = caller->size;
+  test_instr(caller, COIL_OP_SPARAM, 1);
+  test_operand(caller, a_type, COIL_VAL_U64, a, 1);
+  test_instr(caller, COIL_OP_SPARAM, 1);
+  test_operand(caller, b_type, COIL_VAL_U64, b, 1);
+  test_instr(caller, COIL_OP_CALL, 1);
+  test_operand(caller, COIL_TYPEOP_SYM, COIL_VAL_U64, 0, 1);
+  test_instr(caller, COIL_OP_GRET, 1);
+  reg(caller, 2);
+  br_fwd = caller->size + 2 + 3;
+  test_instr(caller, COIL_OP_BR, 1);
+  test_operand(caller, COIL_TYPEOP_OFF, COIL_VAL_U64, 0, 2);
+  br_back = caller->size + 2 + 3;
+  test_instr(caller, COIL_OP_BR, 1);
+  test_operand(caller, COIL_TYPEOP_OFF, COIL_VAL_U64, p->call_at, 2);
+  p->ret_at = caller->size;
+  test_instr(caller, COIL_OP_RET, 0);
+  // the branch targets are filled in once the caller is laid out
+  caller->data[br_fwd] = (coil_byte_t)p->ret_at;
+  caller->data[br_back] = (coil_byte_t)p->call_at;
+
+  test_instr(callee, COIL_OP_GPARAM, 1);
+  reg(callee, 7);
+  test_instr(callee, COIL_OP_GPARAM, 1);
+  reg(callee, 6);
+  test_instr(callee, COIL_OP_ADD, 2);
+  reg(callee, 7);
+  reg(callee, 6);
+  test_instr(callee, COIL_OP_SRET, 1);
+  reg(callee, 7);
+  test_instr(callee, COIL_OP_RET, 0);
+
+  p->headers[CALLER].flags = COIL_SECTION_FLAG_CODE;
+  p->headers[CALLEE].flags = COIL_SECTION_FLAG_CODE;
+  p->symbol.section = CALLEE;
+  p->obj.symbol_count = 1;
+  p->obj.symbols = &p->symbol;
+  p->obj.section_count = 2;
+  p->obj.sectheaders = p->headers;
+  p->obj.sections = p->sections;
+}
+
+static void cleanup(test_program_t *p) {
+  coil_section_cleanup(&p->sections[CALLER]);
+  coil_section_cleanup(&p->sections[CALLEE]);
+}
+
+static coil_size_t inline_caller(test_program_t *p, coil_u32_t threshold, coil_u32_t preserved, coil_section_t *out) {
+  cop_inline_t inl;
+  coil_size_t inlined = 0;
+
+  TEST_CHECK(cop_inline_init(&inl, &p->obj, threshold, preserved) == COIL_ERR_GOOD);
+  TEST_CHECK(cop_inline_section(&inl, CALLER, out, &inlined) == COIL_ERR_GOOD);
+  cop_inline_cleanup(&inl);
+  return inlined;
+}
+
+// Operand i of instr
+static coil_u64_t operand(coil_section_t *sect, const cop_ir_instr_t *instr, int i, coil_u8_t *type) {
+  coil_operand_header_t header;
+  coil_u64_t value = 0;
+  coil_size_t pos = instr->operands;
+
+  for (int k = 0; k <= i && pos; ++k) pos = cop_ir_operand(sect, pos, &header, &value, NULL);
+  *type = pos ? header.type : 0xFF;
+  return value;
+}
+
+static void test_inline(void) {
+  static const coil_u8_t opcodes[] = {COIL_OP_NOP, COIL_OP_MOV, COIL_OP_MOV, COIL_OP_ADD, COIL_OP_MOV, COIL_OP_BR, COIL_OP_BR, COIL_OP_RET};
+  // destination and source of each mov, the parameters and then the return value
+  static const coil_u64_t movs[][2] = {{7, 1}, {6, 5}, {2, 7}};
+  test_program_t p;
+  coil_section_t out = {0};
+  cop_ir_instr_t instrs[8];
+  coil_u8_t type;
+
+  build(&p, 1, COIL_TYPEOP_REG, 5, COIL_TYPEOP_IMM);
+  TEST_CHECK(inline_caller(&p, 8, 1u << 3, &out) == 1);
+
+  coil_size_t pos = 0;
+  int count = 0;
+  while (pos < out.size && count < 8) {
+    pos = cop_ir_decode(&out, pos, &instrs[count]);
+    TEST_CHECK(pos != 0);
+    if (!pos) break;
+    TEST_CHECK(instrs[count].opcode == opcodes[count]);
+    count++;
+  }
+  TEST_CHECK(count == 8 && pos == out.size);
+
+  if (count == 8) {
+    for (int m = 0; m < 3; ++m) {
+      const cop_ir_instr_t *mov = &instrs[m < 2 ? 1 + m : 4];
+      TEST_CHECK(operand(&out, mov, 0, &type) == movs[m][0] && type == COIL_TYPEOP_REG);
+      TEST_CHECK(operand(&out, mov, 1, &type) == movs[m][1]);
+    }
+
+    // the branches follow the ret and the start of the inlined call
+    TEST_CHECK(operand(&out, &instrs[5], 0, &type) == instrs[7].offset && type == COIL_TYPEOP_OFF);
+    TEST_CHECK(operand(&out, &instrs[6], 0, &type) == instrs[1].offset && type == COIL_TYPEOP_OFF);
+    TEST_CHECK(instrs[7].offset != p.ret_at);
+  }
+
+  coil_section_cleanup(&out);
+  cleanup(&p);
+}
+
+// An offset passed as a parameter follows its target like the branches
+static void test_offset_param(void) {
+  test_program_t p;
+  coil_section_t out = {0};
+  cop_ir_instr_t mov = {0}, ret = {0}, instr;
+  coil_u8_t type;
+
+  build(&p, 0, COIL_TYPEOP_OFF, 5, COIL_TYPEOP_IMM);
+  p.sections[CALLER].data[p.call_at + 2 + 3] = (coil_byte_t)p.ret_at;
+  TEST_CHECK(inline_caller(&p, 8, 0, &out) == 1);
+
+  // the first mov is of the parameter, the ret is the last instruction
+  for (coil_size_t pos = 0; pos < out.size; pos = instr.next) {
+    if (!cop_ir_decode(&out, pos, &instr)) break;
+    if (instr.opcode == COIL_OP_MOV && !mov.opcode) mov = instr;
+    ret = instr;
+  }
+
+  TEST_CHECK(mov.opcode == COIL_OP_MOV && ret.opcode == COIL_OP_RET && ret.offset != p.ret_at);
+  TEST_CHECK(operand(&out, &mov, 1, &type) == ret.offset && type == COIL_TYPEOP_OFF);
+
+  coil_section_cleanup(&out);
+  cleanup(&p);
+}
+
+static void test_not_inlined(void) {
+  test_program_t p;
+  coil_section_t out;
+
+  // the callee writes a register the target preserves across calls
+  build(&p, 1, COIL_TYPEOP_REG, 5, COIL_TYPEOP_IMM);
+  TEST_CHECK(inline_caller(&p, 8, 1u << 7, &out) == 0);
+  cleanup(&p);
+
+  // inlining is off
+  build(&p, 1, COIL_TYPEOP_REG, 5, COIL_TYPEOP_IMM);
+  TEST_CHECK(inline_caller(&p, 0, 0, &out) == 0);
+  cleanup(&p);
+
+  // mov r7, r6 would overwrite r7 before mov r6, r7 reads it
+  build(&p, 6, COIL_TYPEOP_REG, 7, COIL_TYPEOP_REG);
+  TEST_CHECK(inline_caller(&p, 8, 0, &out) == 0);
+  cleanup(&p);
+}
+
+int main(void) {
+  test_inline();
+  test_offset_param();
+  test_not_inlined();
+  return TEST_RESULT();
+}
@@ -0,0 +1,72 @@
+#include "test.h"
+#include <src/intern.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define KEYS 50000
+#define KEY_SIZE 24
+
+static void test_put_find(coil_size_t hint) {
+  char (*keys)[KEY_SIZE] = malloc(KEYS * 2 * KEY_SIZE);
+  cop_intern_t tab;
+  coil_u64_t value;
+  int added;
+
+  TEST_CHECK(cop_intern_init(&tab, hint) == COIL_ERR_GOOD);
+
+  // every key is put twice, the second put finds the value of the first
+  for (int i = 0; i < KEYS * 2; ++i) snprintf(keys[i], KEY_SIZE, "sym_%d", i % KEYS);
+  for (int i = 0; i < KEYS * 2; ++i) {
+    coil_u64_t *slot = cop_intern_put(&tab, keys[i], strlen(keys[i]), &added);
+    TEST_CHECK(slot != NULL);
+    if (!slot) break;
+
+    TEST_CHECK(added == (i < KEYS));
+    if (added) *slot = (coil_u64_t)i;
+    else TEST_CHECK(*slot == (coil_u64_t)(i - KEYS));
+  }
+  TEST_CHECK(tab.count == KEYS);
+
+  // entries are kept in insertion order
+  for (int i = 0; i < KEYS; i += 997) TEST_CHECK(tab.entries[i].key == keys[i] && tab.entries[i].value == (coil_u64_t)i);
+
+  for (int i = 0; i < KEYS; ++i) {
+    TEST_CHECK(cop_intern_find(&tab, keys[i], strlen(keys[i]), &value));
+    TEST_CHECK(value == (coil_u64_t)i);
+  }
+  TEST_CHECK(!cop_intern_find(&tab, "sym_-1", 6, &value));
+  TEST_CHECK(!cop_intern_find(&tab, "nope", 4, &value));
+
+  cop_intern_cleanup(&tab);
+  free(keys);
+}
+
+// Keys are compared by length, not by terminator
+static void test_lengths(void) {
+  static const char text[] = "main_loop_body";
+  cop_intern_t tab;
+  coil_u64_t value;
+  int added;
+
+  TEST_CHECK(cop_intern_init(&tab, 0) == COIL_ERR_GOOD);
+
+  for (coil_size_t len = 0; len <= sizeof(text) - 1; ++len) {
+    coil_u64_t *slot = cop_intern_put(&tab, text, len, &added);
+    TEST_CHECK(slot && added);
+    if (slot) *slot = len + 100;
+  }
+  for (coil_size_t len = 0; len <= sizeof(text) - 1; ++len) {
+    TEST_CHECK(cop_intern_find(&tab, text, len, &value));
+    TEST_CHECK(value == len + 100);
+  }
+  TEST_CHECK(tab.count == sizeof(text));
+
+  cop_intern_cleanup(&tab);
+}
+
+int main(void) {
+  test_put_find(0);
+  test_put_find(KEYS);
+  test_lengths();
+  return TEST_RESULT();
+}
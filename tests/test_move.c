@@ -0,0 +1,245 @@
+// Parameter moves of the x86-64 frame lowering, run through an interpreter of the emitted code
+
+#include "test.h"
+#include <src/codegen.h>
+#include <src/ir.h>
+#include <src/profile.h>
+#include <stdlib.h>
+#include <string.h>
+
+cop_codegen_state_t cop_codegen_state;
+
+#include "../src/codegen/cpu/x86/x86_emit.h"
+#include "../src/codegen/cpu/x86/x86_probe.h"
+#include "../src/codegen/cpu/x86/x86_frame.h"
+
+#define LOCS 32
+
+// Register file, locations as in x86_frame.h
+static coil_u64_t regs[LOCS];
+static coil_u64_t called;
+
+// Run the mov, xchg, movd/movq and call reg forms the frame lowering emits, 0 on anything else
+static int run(const coil_byte_t *code, coil_size_t size) {
+  coil_size_t i = 0;
+
+  while (i < size) {
+    int prefix = 0;
+    coil_byte_t rex = 0;
+
+    if (code[i] == 0x66) prefix = code[i++];
+    if (i < size && (code[i] & 0xF0) == X86_REX) rex = code[i++];
+    if (i >= size) return 0;
+
+    int w = rex & X86_REX_W;
+    coil_u8_t r = rex & X86_REX_R ? 8 : 0;
+    coil_u8_t b = rex & X86_REX_B ? 8 : 0;
+    coil_byte_t op = code[i++];
+    coil_byte_t modrm = i < size ? code[i] : 0;
+    coil_u8_t reg = ((modrm >> 3) & 7) | r, rm = (modrm & 7) | b;
+
+    if (op == 0x89 && w && (modrm & 0xC0) == 0xC0) {
+      regs[rm] = regs[reg];
+      i++;
+    } else if (op == 0x87 && w && (modrm & 0xC0) == 0xC0) {
+      coil_u64_t t = regs[rm];
+      regs[rm] = regs[reg];
+      regs[reg] = t;
+      i++;
+    } else if ((op & 0xF8) == 0xB8) {
+      coil_size_t n = w ? 8 : 4;
+      coil_u64_t imm = 0;
+      if (i + n > size) return 0;
+      for (coil_size_t k = 0; k < n; ++k) imm |= (coil_u64_t)code[i + k] << (k * 8);
+      regs[(op & 7) | b] = imm;
+      i += n;
+    } else if (op == 0xC7 && w && (modrm & 0xF8) == 0xC0) {
+      coil_u32_t imm = 0;
+      if (i + 5 > size) return 0;
+      for (coil_size_t k = 0; k < 4; ++k) imm |= (coil_u32_t)code[i + 1 + k] << (k * 8);
+      regs[rm] = (coil_u64_t)(int64_t)(int32_t)imm;
+      i += 5;
+    } else if (op == 0x0F && prefix && i + 1 < size && (code[i] == 0x6E || code[i] == 0x7E)) {
+      coil_u64_t mask = w ? ~0ull : 0xFFFFFFFFull;
+      modrm = code[i + 1];
+      if ((modrm & 0xC0) != 0xC0) return 0;
+      coil_u8_t xmm = X86_LOC_XMM + (((modrm >> 3) & 7) | r), gpr = (modrm & 7) | b;
+      if (code[i] == 0x6E) regs[xmm] = regs[gpr] & mask;
+      else regs[gpr] = regs[xmm] & mask;
+      i += 2;
+    } else if (op == 0xFF && (modrm & 0xF8) == 0xD0) {
+      called = regs[rm];
+      i++;
+    } else {
+      return 0;
+    }
+  }
+
+  return 1;
+}
+
+static void reset(coil_section_t *native) {
+  for (int i = 0; i < LOCS; ++i) regs[i] = 0x1000 + i;
+  called = 0;
+  native->rindex = native->windex = native->size = 0;
+  memset(&__x86_frame, 0, sizeof(__x86_frame));
+}
+
+// Random queues of the two shapes the lowering builds, xmm registers are never read and written by one queue
+// sparam:  parameter registers and xmm0-7 from any register or an immediate, with r11 from a call target
+// gparam:  any register from parameter registers and xmm0-7
+static void test_flush(coil_section_t *native) {
+  static const coil_u64_t imms[] = {7, 0xFFFFFFFFull, 0xFFFFFFFFFFFFFFF0ull, 0x1122334455667788ull};
+
+  for (int t = 0; t < 100000; ++t) {
+    coil_u64_t want[LOCS];
+    coil_u32_t dsts = 0;
+    int entry = rand() % 2;
+    int count = rand() % (X86_MOVES_MAX + 1);
+
+    reset(native);
+    memcpy(want, regs, sizeof(regs));
+
+    for (int k = 0; k < count; ++k) {
+      coil_u8_t param = rand() % 3 ? __x86_sysv_int_args[rand() % X86_SYSV_INT_ARGS] : (coil_u8_t)(X86_LOC_XMM + rand() % X86_SYSV_SSE_ARGS);
+      coil_u8_t other;
+      do other = (coil_u8_t)(rand() % 16); while (other == X86_RSP || other == X86_RBP);
+
+      coil_u8_t dst = entry ? other : param;
+      coil_u8_t src = entry ? param : other;
+      if ((dsts >> dst) & 1) continue;
+      dsts |= 1u << dst;
+
+      int wide = (dst < X86_LOC_XMM && src < X86_LOC_XMM) || rand() % 2;
+      coil_u64_t mask = wide ? ~0ull : 0xFFFFFFFFull;
+
+      if (!entry && rand() % 4 == 0) {
+        __x86_operand_t imm = {{COIL_TYPEOP_IMM, COIL_VAL_U64}, imms[rand() % 4]};
+        TEST_CHECK(__x86_move_queue(dst, &imm, wide) == COIL_ERR_GOOD);
+        want[dst] = dst < X86_LOC_XMM ? imm.value : imm.value & mask;
+      } else {
+        TEST_CHECK(__x86_move_queue_loc(dst, src, wide) == COIL_ERR_GOOD);
+        want[dst] = regs[src] & mask;
+      }
+    }
+
+    if (!entry && !((dsts >> X86_R11) & 1) && rand() % 2) {
+      coil_u8_t target = __x86_sysv_int_args[rand() % X86_SYSV_INT_ARGS];
+      TEST_CHECK(__x86_move_queue_loc(X86_R11, target, 0) == COIL_ERR_GOOD);
+      dsts |= 1u << X86_R11;
+      want[X86_R11] = regs[target];
+    }
+
+    // float immediates go through a scratch register, rax and r10 are never parameters
+    TEST_CHECK(__x86_move_flush() == COIL_ERR_GOOD);
+    TEST_CHECK(run(native->data, native->size));
+
+    // scratch registers are caller saved, everything else keeps its value
+    coil_u32_t scratch = (1u << X86_R11) | (1u << X86_R10) | (1u << X86_RAX) | (1u << X86_RCX) | (1u << X86_RDX) |
+      (1u << X86_RSI) | (1u << X86_RDI) | (1u << X86_R8) | (1u << X86_R9);
+    for (int i = 0; i < LOCS; ++i) {
+      if ((dsts >> i) & 1) TEST_CHECK(regs[i] == want[i]);
+      else if (!((scratch >> i) & 1)) TEST_CHECK(regs[i] == want[i]);
+    }
+  }
+}
+
+// Append sparam with a single operand
+static void sparam(coil_section_t *ir, coil_u8_t type, coil_u8_t value_type, coil_u64_t value) {
+  test_instr(ir, COIL_OP_SPARAM, 1);
+  test_operand(ir, type, value_type, value, 8);
+}
+
+// sparam from registers that are also parameter registers, then call through one of them
+// Half of the calls also fill every SSE parameter register, so the queue is full with r11
+static void test_call(coil_section_t *native) {
+  coil_object_t obj = {0};
+  cop_stats_t stats = {0};
+  cop_codegen_state.stats = &stats;
+
+  for (int t = 0; t < 2000; ++t) {
+    coil_section_t ir;
+    cop_ir_instr_t instr;
+    coil_u8_t srcs[X86_SYSV_INT_ARGS];
+    int count = rand() % (X86_SYSV_INT_ARGS + 1);
+    coil_u8_t target = __x86_sysv_int_args[rand() % X86_SYSV_INT_ARGS];
+
+    reset(native);
+    TEST_CHECK(coil_section_init(&ir, 64) == COIL_ERR_GOOD);
+    for (int k = 0; k < count; ++k) {
+      do srcs[k] = (coil_u8_t)(rand() % 16); while (srcs[k] == X86_RSP || srcs[k] == X86_RBP);
+      sparam(&ir, COIL_TYPEOP_REG, COIL_VAL_U64, srcs[k]);
+    }
+    int floats = rand() % 2 ? X86_SYSV_SSE_ARGS : 0;
+    for (int k = 0; k < floats; ++k) sparam(&ir, COIL_TYPEOP_IMM, COIL_VAL_F64, 0x4000000000000000ull + k);
+    test_instr(&ir, COIL_OP_CALL, 1);
+    test_operand(&ir, COIL_TYPEOP_REG, COIL_VAL_U64, target, 1);
+
+    coil_u64_t before[LOCS];
+    memcpy(before, regs, sizeof(regs));
+
+    for (coil_size_t pos = 0; pos < ir.size; pos = instr.next) {
+      TEST_CHECK(cop_ir_decode(&ir, pos, &instr));
+      ir.rindex = instr.operands;
+      if (instr.opcode == COIL_OP_SPARAM) TEST_CHECK(__x86_frame_sparam(&ir) == COIL_ERR_GOOD);
+      else TEST_CHECK(__x86_frame_call(&obj, &ir) == COIL_ERR_GOOD);
+    }
+
+    TEST_CHECK(run(native->data, native->size));
+    TEST_CHECK(called == before[target]);
+    for (int k = 0; k < count; ++k) TEST_CHECK(regs[__x86_sysv_int_args[k]] == before[srcs[k]]);
+    for (int k = 0; k < floats; ++k) TEST_CHECK(regs[X86_LOC_XMM + k] == 0x4000000000000000ull + k);
+    coil_section_cleanup(&ir);
+  }
+}
+
+// An instruction between sparam and call must not overwrite a queued source
+static void test_guard(coil_section_t *native) {
+  coil_section_t ir;
+  cop_ir_instr_t instr;
+
+  reset(native);
+  TEST_CHECK(coil_section_init(&ir, 64) == COIL_ERR_GOOD);
+  sparam(&ir, COIL_TYPEOP_REG, COIL_VAL_U64, X86_RBX);
+  sparam(&ir, COIL_TYPEOP_IMM, COIL_VAL_U64, 5);
+  coil_size_t mov_rax = ir.size;
+  test_instr(&ir, COIL_OP_MOV, 2);
+  test_operand(&ir, COIL_TYPEOP_REG, COIL_VAL_U64, X86_RAX, 1);
+  test_operand(&ir, COIL_TYPEOP_IMM, COIL_VAL_U64, 1, 1);
+  coil_size_t mov_rbx = ir.size;
+  test_instr(&ir, COIL_OP_MOV, 2);
+  test_operand(&ir, COIL_TYPEOP_REG, COIL_VAL_U64, X86_RBX, 1);
+  test_operand(&ir, COIL_TYPEOP_IMM, COIL_VAL_U64, 1, 1);
+  coil_size_t cpuid = ir.size;
+  test_instr(&ir, COIL_OP_CPUID, 0);
+
+  for (coil_size_t pos = 0; pos < mov_rax; pos = instr.next) {
+    TEST_CHECK(cop_ir_decode(&ir, pos, &instr));
+    ir.rindex = instr.operands;
+    TEST_CHECK(__x86_frame_sparam(&ir) == COIL_ERR_GOOD);
+  }
+
+  TEST_CHECK(cop_ir_decode(&ir, mov_rax, &instr));
+  TEST_CHECK(__x86_move_guard(&ir, &instr) == COIL_ERR_GOOD);
+  TEST_CHECK(cop_ir_decode(&ir, mov_rbx, &instr));
+  TEST_CHECK(__x86_move_guard(&ir, &instr) == COIL_ERR_NOTSUP);
+  TEST_CHECK(cop_ir_decode(&ir, cpuid, &instr));
+  TEST_CHECK(__x86_move_guard(&ir, &instr) == COIL_ERR_NOTSUP);
+
+  coil_section_cleanup(&ir);
+}
+
+int main(void) {
+  coil_section_t native;
+
+  srand(3);
+  TEST_CHECK(coil_section_init(&native, 256) == COIL_ERR_GOOD);
+  cop_codegen_state.native = &native;
+
+  test_flush(&native);
+  test_call(&native);
+  test_guard(&native);
+
+  coil_section_cleanup(&native);
+  return TEST_RESULT();
+}
@@ -0,0 +1,96 @@
+// Function probes of the x86-64 generator
+
+#include "test.h"
+#include <src/codegen.h>
+#include <src/ir.h>
+#include <src/profile.h>
+#include <string.h>
+
+cop_codegen_state_t cop_codegen_state;
+
+#include "../src/codegen/cpu/x86/x86_emit.h"
+#include "../src/codegen/cpu/x86/x86_probe.h"
+
+#define SYMBOL 7
+#define RECORD (2 * COP_PROFILE_RECORD)
+
+// Emit one probe and compare it with want, the rip relative displacements are left 0 for their relocations
+static void check(coil_err_t (*probe)(void), const coil_byte_t *want, coil_size_t size) {
+  coil_section_t *native = cop_codegen_state.native;
+
+  native->windex = native->size = 0;
+  test_reloc_count = 0;
+  TEST_CHECK(probe() == COIL_ERR_GOOD);
+  TEST_CHECK(native->size == size && memcmp(native->data, want, size) == 0);
+}
+
+// Relocation i points at the displacement at offset for the counter field
+static void check_reloc(coil_size_t i, coil_size_t offset, coil_size_t field) {
+  TEST_CHECK(i < test_reloc_count);
+  if (i >= test_reloc_count) return;
+
+  // the displacement is relative to the end of the instruction, 4 bytes after it starts
+  const test_reloc_t *reloc = &test_relocs[i];
+  TEST_CHECK(reloc->offset == offset && reloc->symbol == SYMBOL && reloc->type == COIL_RELOC_REL32);
+  TEST_CHECK(reloc->addend == (int64_t)(RECORD + field) - 4);
+}
+
+static void test_tsc(void) {
+  static const coil_byte_t enter[] = {
+    0x50, 0x52,                     // push rax; push rdx
+    0x0F, 0x31,                     // rdtsc
+    0x48, 0xC1, 0xE2, 0x20,         // shl rdx, 32
+    0x48, 0x09, 0xD0,               // or rax, rdx
+    0x48, 0xFF, 0x05, 0, 0, 0, 0,   // inc qword [rip + calls]
+    0x48, 0x29, 0x05, 0, 0, 0, 0,   // sub [rip + cycles], rax
+    0x5A, 0x58,                     // pop rdx; pop rax
+  };
+  static const coil_byte_t leave[] = {
+    0x50, 0x52, 0x0F, 0x31, 0x48, 0xC1, 0xE2, 0x20, 0x48, 0x09, 0xD0,
+    0x48, 0x01, 0x05, 0, 0, 0, 0,   // add [rip + cycles], rax
+    0x5A, 0x58,
+  };
+
+  check(__x86_probe_enter, enter, sizeof(enter));
+  TEST_CHECK(test_reloc_count == 2);
+  check_reloc(0, 14, COP_PROFILE_CALLS);
+  check_reloc(1, 21, COP_PROFILE_CYCLES);
+
+  check(__x86_probe_leave, leave, sizeof(leave));
+  TEST_CHECK(test_reloc_count == 1);
+  check_reloc(0, 14, COP_PROFILE_CYCLES);
+}
+
+static void test_pmc(void) {
+  static const coil_byte_t leave[] = {
+    0x50, 0x52, 0x51,               // push rax; push rdx; push rcx
+    0xB9, 0x04, 0x03, 0x02, 0x01,   // mov ecx, counter
+    0x0F, 0x33,                     // rdpmc
+    0x48, 0xC1, 0xE2, 0x20, 0x48, 0x09, 0xD0,
+    0x48, 0x01, 0x05, 0, 0, 0, 0,   // add [rip + cycles], rax
+    0x59, 0x5A, 0x58,               // pop rcx; pop rdx; pop rax
+  };
+
+  check(__x86_probe_leave, leave, sizeof(leave));
+  TEST_CHECK(test_reloc_count == 1);
+  check_reloc(0, 20, COP_PROFILE_CYCLES);
+}
+
+int main(void) {
+  coil_section_t native;
+  cop_config_t conf = {0};
+
+  TEST_CHECK(coil_section_init(&native, 64) == COIL_ERR_GOOD);
+  cop_codegen_state.conf = &conf;
+  cop_codegen_state.native = &native;
+  cop_codegen_state.probe_symbol = SYMBOL;
+  cop_codegen_state.probe_record = RECORD;
+
+  conf.probe_counter = -1;
+  test_tsc();
+  conf.probe_counter = 0x01020304;
+  test_pmc();
+
+  coil_section_cleanup(&native);
+  return TEST_RESULT();
+}
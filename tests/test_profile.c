@@ -0,0 +1,91 @@
+#include "test.h"
+#include <src/profile.h>
+#include <string.h>
+
+// section and function names at their offsets
+static const char strings[] = "code\0" COP_PROFILE_SECTION "\0parse\0eval\0";
+#define NAME_CODE 0
+#define NAME_PROF 5
+#define NAME_PARSE (NAME_PROF + sizeof(COP_PROFILE_SECTION))
+#define NAME_EVAL (NAME_PARSE + 6)
+
+typedef struct test_program_s {
+  coil_section_header_t headers[2];
+  coil_section_t sections[2];
+  coil_object_t obj;
+} test_program_t;
+
+static void build(test_program_t *p) {
+  coil_size_t offset;
+
+  memset(p, 0, sizeof(*p));
+  coil_section_init(&p->sections[0], 16);
+  coil_section_init(&p->sections[1], 16);
+  p->headers[0].name = NAME_CODE;
+  p->headers[1].name = NAME_PROF;
+
+  TEST_CHECK(cop_profile_add(&p->sections[1], NAME_PARSE, &offset) == COIL_ERR_GOOD && offset == 0);
+  TEST_CHECK(cop_profile_add(&p->sections[1], NAME_EVAL, &offset) == COIL_ERR_GOOD && offset == COP_PROFILE_RECORD);
+
+  p->obj.section_count = 2;
+  p->obj.sectheaders = p->headers;
+  p->obj.sections = p->sections;
+}
+
+static void cleanup(test_program_t *p) {
+  coil_section_cleanup(&p->sections[0]);
+  coil_section_cleanup(&p->sections[1]);
+}
+
+static void put64(coil_byte_t *p, coil_u64_t v) {
+  for (int i = 0; i < 8; ++i) p[i] = (coil_byte_t)(v >> (i * 8));
+}
+
+static void test_report(void) {
+  test_program_t p;
+  coil_byte_t dump[2 * COP_PROFILE_RECORD];
+  char line[128], name[16];
+  unsigned long long cycles, calls;
+  double per_call;
+
+  build(&p);
+
+  // the program may scribble over the names, they are read from the object
+  memset(dump, 0xFF, sizeof(dump));
+  put64(dump + COP_PROFILE_CALLS, 10);
+  put64(dump + COP_PROFILE_CYCLES, 100);
+  put64(dump + COP_PROFILE_RECORD + COP_PROFILE_CALLS, 4);
+  put64(dump + COP_PROFILE_RECORD + COP_PROFILE_CYCLES, 1000);
+
+  FILE *stream = tmpfile();
+  TEST_CHECK(stream != NULL);
+  if (!stream) return;
+  TEST_CHECK(cop_profile_report(stream, &p.obj, dump, sizeof(dump)) == COIL_ERR_GOOD);
+  rewind(stream);
+
+  // a header, then the functions with the most cycles first
+  TEST_CHECK(fgets(line, sizeof(line), stream) && strstr(line, "cycles/call"));
+  TEST_CHECK(fscanf(stream, "%llu %llu %lf %15s", &cycles, &calls, &per_call, name) == 4);
+  TEST_CHECK(cycles == 1000 && calls == 4 && per_call == 250.0 && strcmp(name, "eval") == 0);
+  TEST_CHECK(fscanf(stream, "%llu %llu %lf %15s", &cycles, &calls, &per_call, name) == 4);
+  TEST_CHECK(cycles == 100 && calls == 10 && per_call == 10.0 && strcmp(name, "parse") == 0);
+  TEST_CHECK(fscanf(stream, "%15s", name) == EOF);
+  fclose(stream);
+
+  // a dump of another build of the program
+  TEST_CHECK(cop_profile_report(stderr, &p.obj, dump, COP_PROFILE_RECORD) == COIL_ERR_FORMAT);
+  TEST_CHECK(cop_profile_report(stderr, &p.obj, dump, sizeof(dump) - 1) == COIL_ERR_FORMAT);
+
+  // an object built without --instrument
+  p.obj.section_count = 1;
+  TEST_CHECK(cop_profile_report(stderr, &p.obj, dump, sizeof(dump)) == COIL_ERR_NOTFOUND);
+
+  cleanup(&p);
+}
+
+int main(void) {
+  test_strings = strings;
+  test_strings_size = sizeof(strings);
+  test_report();
+  return TEST_RESULT();
+}
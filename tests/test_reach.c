@@ -0,0 +1,126 @@
+#include "test.h"
+#include <src/reach.h>
+#include <string.h>
+
+#define SECTIONS 5
+#define UNDEFINED SECTIONS  // symbol of another object
+
+typedef struct test_program_s {
+  coil_section_header_t headers[SECTIONS];
+  coil_section_t sections[SECTIONS];
+  coil_symbol_t symbols[SECTIONS + 1];
+  coil_object_t obj;
+} test_program_t;
+
+static void sym(coil_section_t *sect, coil_u64_t symbol) {
+  test_operand(sect, COIL_TYPEOP_SYM, COIL_VAL_U64, symbol, 1);
+}
+
+// symbol i names section i, the last symbol is undefined
+// 0:  mov r1, sym1; call sym5; ret         a function address stored with mov, not called
+// 1:  sparam sym4; call sym2; ret          sym4 names a data section
+// 2:  call sym0; ret                       back to the root
+// 3:  ret                                  nothing refers to it
+// 4:  data that decodes as call sym3       data is not followed
+static void build(test_program_t *p) {
+  coil_section_t *s = p->sections;
+
+  memset(p, 0, sizeof(*p));
+  for (int i = 0; i < SECTIONS; ++i) {
+    coil_section_init(&s[i], 32);
+    p->headers[i].flags = i == 4 ? 0 : COIL_SECTION_FLAG_CODE;
+    p->symbols[i].section = (coil_u16_t)i;
+  }
+  p->symbols[SECTIONS].section = 0xFFFF;
+
+  test_instr(&s[0], COIL_OP_MOV, 2);
+  test_operand(&s[0], COIL_TYPEOP_REG, COIL_VAL_U64, 1, 1);
+  sym(&s[0], 1);
+  test_instr(&s[0], COIL_OP_CALL, 1);
+  sym(&s[0], UNDEFINED);
+  test_instr(&s[0], COIL_OP_RET, 0);
+
+  test_instr(&s[1], COIL_OP_SPARAM, 1);
+  sym(&s[1], 4);
+  test_instr(&s[1], COIL_OP_CALL, 1);
+  sym(&s[1], 2);
+  test_instr(&s[1], COIL_OP_RET, 0);
+
+  test_instr(&s[2], COIL_OP_CALL, 1);
+  sym(&s[2], 0);
+  test_instr(&s[2], COIL_OP_RET, 0);
+
+  test_instr(&s[3], COIL_OP_RET, 0);
+
+  test_instr(&s[4], COIL_OP_CALL, 1);
+  sym(&s[4], 3);
+
+  p->obj.section_count = SECTIONS;
+  p->obj.sectheaders = p->headers;
+  p->obj.sections = p->sections;
+  p->obj.symbol_count = SECTIONS + 1;
+  p->obj.symbols = p->symbols;
+}
+
+static void cleanup(test_program_t *p) {
+  for (int i = 0; i < SECTIONS; ++i) coil_section_cleanup(&p->sections[i]);
+}
+
+static void test_reach(void) {
+  static const coil_u8_t want[SECTIONS] = {1, 1, 1, 0, 1};
+  test_program_t p;
+  coil_u8_t reachable[SECTIONS];
+  coil_u16_t root = 0;
+
+  build(&p);
+  TEST_CHECK(cop_reach_mark(&p.obj, &root, 1, reachable) == COIL_ERR_GOOD);
+  for (int i = 0; i < SECTIONS; ++i) TEST_CHECK(reachable[i] == want[i]);
+
+  // the cycle is reached from any of its sections
+  root = 2;
+  TEST_CHECK(cop_reach_mark(&p.obj, &root, 1, reachable) == COIL_ERR_GOOD);
+  for (int i = 0; i < SECTIONS; ++i) TEST_CHECK(reachable[i] == want[i]);
+
+  // a section nothing refers to is only reached as a root
+  root = 3;
+  TEST_CHECK(cop_reach_mark(&p.obj, &root, 1, reachable) == COIL_ERR_GOOD);
+  for (int i = 0; i < SECTIONS; ++i) TEST_CHECK(reachable[i] == (i == 3));
+
+  cleanup(&p);
+}
+
+static void test_roots(void) {
+  test_program_t p;
+  coil_u8_t reachable[SECTIONS];
+  const coil_u16_t roots[] = {3, 3, SECTIONS, 4};
+
+  // repeated and out of range roots are harmless, a data root is marked but not followed
+  build(&p);
+  TEST_CHECK(cop_reach_mark(&p.obj, roots, 4, reachable) == COIL_ERR_GOOD);
+  for (int i = 0; i < SECTIONS; ++i) TEST_CHECK(reachable[i] == (i == 3 || i == 4));
+
+  // no roots reach nothing
+  TEST_CHECK(cop_reach_mark(&p.obj, roots, 0, reachable) == COIL_ERR_GOOD);
+  for (int i = 0; i < SECTIONS; ++i) TEST_CHECK(reachable[i] == 0);
+
+  cleanup(&p);
+}
+
+static void test_truncated(void) {
+  test_program_t p;
+  coil_u8_t reachable[SECTIONS];
+  coil_u16_t root = 2;
+
+  // an operand cut off by the end of the section is an error, the call keeps only the header of its operand
+  build(&p);
+  p.sections[2].size = 2 + 3;
+  TEST_CHECK(cop_reach_mark(&p.obj, &root, 1, reachable) != COIL_ERR_GOOD);
+  cleanup(&p);
+}
+
+int main(void) {
+  test_reach();
+  test_roots();
+  test_truncated();
+  return TEST_RESULT();
+}
@@ -0,0 +1,96 @@
+// Handlers of the x86 generators instantiated from x86_gen.h, against the encodings of the per width copies they replaced
+
+#include "test.h"
+#include <src/codegen.h>
+#include <string.h>
+
+cop_codegen_state_t cop_codegen_state;
+
+#include "../src/codegen/cpu/x86/main.c"
+
+typedef struct test_encoding_s {
+  coil_u8_t opcode;
+  coil_u8_t size;
+  coil_byte_t code[4];
+} test_encoding_t;
+
+// Everything not listed emits nothing
+// x86-16 ret, iret, cli and sti wrote into the IR section before, they are compared in native
+static const test_encoding_t enc16[] = {
+  {COIL_OP_NOP, 1, {0x90}},
+  {COIL_OP_RET, 1, {0xC3}},
+  {COIL_OP_IRET, 1, {0xCF}},
+  {COIL_OP_CLI, 1, {0xFA}},
+  {COIL_OP_STI, 1, {0xFB}},
+  {COIL_OP_SYSRET, 1, {0xCF}},
+};
+// ret, iret, cli and sti were added for x86-32 after the refactor
+static const test_encoding_t enc32[] = {
+  {COIL_OP_NOP, 1, {0x90}},
+  {COIL_OP_RET, 1, {0xC3}},
+  {COIL_OP_IRET, 1, {0xCF}},
+  {COIL_OP_CLI, 1, {0xFA}},
+  {COIL_OP_STI, 1, {0xFB}},
+};
+// iret, cli, sti and sysret were added for x86-64 after the refactor
+static const test_encoding_t enc64[] = {
+  {COIL_OP_NOP, 1, {0x90}},
+  {COIL_OP_RET, 1, {0xC3}},
+  {COIL_OP_IRET, 2, {0x48, 0xCF}},
+  {COIL_OP_CLI, 1, {0xFA}},
+  {COIL_OP_STI, 1, {0xFB}},
+  {COIL_OP_SYSRET, 3, {0x48, 0x0F, 0x07}},
+};
+
+// Lowered through the System V frame from their operands, covered by test_move
+static int frame_op(coil_u8_t opcode) {
+  return opcode == COIL_OP_CALL || opcode == COIL_OP_SPARAM || opcode == COIL_OP_GPARAM ||
+    opcode == COIL_OP_SRET || opcode == COIL_OP_GRET;
+}
+
+static void check(const cop_codegen_ft *table, const test_encoding_t *enc, size_t count, int frame) {
+  coil_section_t *native = cop_codegen_state.native;
+  coil_section_header_t header = {0};
+  coil_object_t obj = {0};
+  coil_section_t ir;
+
+  TEST_CHECK(coil_section_init(&ir, 16) == COIL_ERR_GOOD);
+
+  for (unsigned op = 0; op < 256; ++op) {
+    // every COIL opcode has a handler, there is none past the last one
+    TEST_CHECK(!table[op] == (op > COIL_OP_GRET));
+    if (!table[op] || (frame && frame_op((coil_u8_t)op))) continue;
+
+    const test_encoding_t *want = NULL;
+    for (size_t i = 0; i < count; ++i) {
+      if (enc[i].opcode == op) want = &enc[i];
+    }
+
+    native->windex = native->size = 0;
+    memset(&__x86_frame, 0, sizeof(__x86_frame));
+    TEST_CHECK(table[op](&obj, &header, &ir) == COIL_ERR_GOOD);
+    TEST_CHECK(ir.size == 0);
+    if (want) TEST_CHECK(native->size == want->size && memcmp(native->data, want->code, want->size) == 0);
+    else TEST_CHECK(native->size == 0);
+  }
+
+  coil_section_cleanup(&ir);
+}
+
+int main(void) {
+  coil_section_t native;
+  cop_config_t conf = {0};
+  cop_stats_t stats = {0};
+
+  TEST_CHECK(coil_section_init(&native, 16) == COIL_ERR_GOOD);
+  cop_codegen_state.conf = &conf;
+  cop_codegen_state.stats = &stats;
+  cop_codegen_state.native = &native;
+
+  check(__x86_codegen_comp16_table, enc16, sizeof(enc16) / sizeof(enc16[0]), 0);
+  check(__x86_codegen_comp32_table, enc32, sizeof(enc32) / sizeof(enc32[0]), 0);
+  check(__x86_codegen_comp64_table, enc64, sizeof(enc64) / sizeof(enc64[0]), 1);
+
+  coil_section_cleanup(&native);
+  return TEST_RESULT();
+}